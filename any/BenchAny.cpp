@@ -0,0 +1,448 @@
+#include <benchmark/benchmark.h>
+#include "any.h"
+#include "any_batch.h"
+#include "compact_any.h"
+#include "any_of.h"
+#include "any_unchecked.h"
+#include "any_visit.h"
+#include <algorithm>
+#include <any>
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if ANY_BENCH_HAS_BOOST
+#include <boost/any.hpp>
+#endif
+
+/*
+	The basic operations of <any> and <compact_any> next to std::any (and boost::any when the build finds it).
+
+	Every operation runs over payloads whose size and alignment sit on both sides of small_space_size and
+	small_space_align, so the numbers show where each implementation switches to the heap.
+	Results are named <operation>/<any>/<size>x<align>.
+	Dispatch/<how>/<N> compares a chain of N any_casts with any_visit over the same N alternatives, and with visit on an
+	any_of of them. VectorAssign/any_copy and Gather/any_gather are the batch operations of any_batch.h, the latter
+	against a loop of any_casts over a vector where every other value is the wanted type. Sum/<cast> reads every value
+	of a vector through any_cast or any_cast_unchecked, and through any_cast over a vector of cache_line_any.
+*/
+
+template<size_t Size, size_t Align>
+struct alignas(Align) Payload
+{
+	std::array<unsigned char, Size> data{};
+};
+
+// The few places where the three interfaces differ.
+template<class T>
+T* Cast(any& a) { return any_cast<T>(&a); }
+
+template<class T>
+void Emplace(any& a) { a.emplace<T>(); }
+
+inline void Reset(any& a) { a.reset(); }
+
+template<class T>
+T* Cast(compact_any& a) { return any_cast<T>(&a); }
+
+template<class T>
+void Emplace(compact_any& a) { a.emplace<T>(); }
+
+inline void Reset(compact_any& a) { a.reset(); }
+
+template<class T>
+T* Cast(std::any& a) { return std::any_cast<T>(&a); }
+
+template<class T>
+void Emplace(std::any& a) { a.emplace<T>(); }
+
+inline void Reset(std::any& a) { a.reset(); }
+
+#if ANY_BENCH_HAS_BOOST
+template<class T>
+T* Cast(boost::any& a) { return boost::any_cast<T>(&a); }
+
+template<class T>
+void Emplace(boost::any& a) { a = T{}; }
+
+inline void Reset(boost::any& a) { a.clear(); }
+#endif
+
+constexpr int batch = 256;
+
+template<class Any, class T>
+static void BM_Construct(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		Any a = T{};
+		benchmark::DoNotOptimize(a);
+	}
+}
+
+template<class Any, class T>
+static void BM_Copy(benchmark::State& state)
+{
+	const Any source = T{};
+
+	for (auto _ : state)
+	{
+		Any a = source;
+		benchmark::DoNotOptimize(a);
+	}
+}
+
+template<class Any, class T>
+static void BM_Move(benchmark::State& state)
+{
+	Any a = T{};
+
+	for (auto _ : state)
+	{
+		Any b = std::move(a);
+		a = std::move(b);
+		benchmark::DoNotOptimize(a);
+	}
+}
+
+template<class Any, class T>
+static void BM_Swap(benchmark::State& state)
+{
+	Any a = T{};
+	Any b = T{};
+
+	for (auto _ : state)
+	{
+		using std::swap;
+		swap(a, b);
+		benchmark::DoNotOptimize(a);
+		benchmark::DoNotOptimize(b);
+	}
+}
+
+// Replaces a value of the same type, so it includes destroying the previous one.
+template<class Any, class T>
+static void BM_Emplace(benchmark::State& state)
+{
+	Any a = T{};
+
+	for (auto _ : state)
+	{
+		Emplace<T>(a);
+		benchmark::DoNotOptimize(a);
+	}
+}
+
+template<class Any, class T>
+static void BM_Reset(benchmark::State& state)
+{
+	std::vector<Any> values(batch);
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		for (Any& a : values)
+		{
+			Emplace<T>(a);
+		}
+		state.ResumeTiming();
+
+		for (Any& a : values)
+		{
+			Reset(a);
+		}
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * batch);
+}
+
+template<class Any, class T>
+static void BM_CastHit(benchmark::State& state)
+{
+	Any a = T{};
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(Cast<T>(a));
+	}
+}
+
+template<class Any, class T>
+static void BM_CastMiss(benchmark::State& state)
+{
+	Any a = T{};
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(Cast<std::string>(a));
+	}
+}
+
+// Growing the vector moves every element.
+template<class Any, class T>
+static void BM_VectorPushBack(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		std::vector<Any> values;
+		for (int i = 0; i < batch; ++i)
+		{
+			values.push_back(T{});
+		}
+		benchmark::DoNotOptimize(values.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * batch);
+}
+
+// Sorting by the payload: a cast per comparison and a move per element swap.
+template<class Any, class T>
+static void BM_VectorSort(benchmark::State& state)
+{
+	std::vector<Any> values(batch);
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		for (int i = 0; i < batch; ++i)
+		{
+			T value{};
+			value.data[0] = static_cast<unsigned char>((i * 7919) % 251);
+			values[i] = value;
+		}
+		state.ResumeTiming();
+
+		std::sort(values.begin(), values.end(), [](Any& a, Any& b)
+		{
+			return Cast<T>(a)->data[0] < Cast<T>(b)->data[0];
+		});
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * batch);
+}
+
+// Copying into a vector of the same size, as when double buffering.
+template<class Any, class T>
+static void BM_VectorAssign(benchmark::State& state)
+{
+	const std::vector<Any> values(batch, T{});
+	std::vector<Any> copy(batch);
+
+	for (auto _ : state)
+	{
+		copy = values;
+		benchmark::DoNotOptimize(copy.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * batch);
+}
+
+template<class T>
+static void BM_VectorAssignBatch(benchmark::State& state)
+{
+	const std::vector<any> values(batch, T{});
+	std::vector<any> copy(batch);
+
+	for (auto _ : state)
+	{
+		any_copy(values.data(), values.data() + batch, copy.data());
+		benchmark::DoNotOptimize(copy.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * batch);
+}
+
+// Reading one byte of every value, checked on every access or once up front.
+template<class Any, class T>
+static void BM_SumCast(benchmark::State& state)
+{
+	const std::vector<Any> values(batch, T{});
+
+	for (auto _ : state)
+	{
+		unsigned sum = 0;
+		for (const Any& value : values)
+		{
+			sum += any_cast<T>(&value)->data[0];
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * batch);
+}
+
+template<class T>
+static void BM_SumUnchecked(benchmark::State& state)
+{
+	const std::vector<any> values(batch, T{});
+
+	for (auto _ : state)
+	{
+		unsigned sum = 0;
+		for (const any& value : values)
+		{
+			sum += any_cast_unchecked<T>(value).data[0];
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * batch);
+}
+
+// Every other element is a T, the rest ints.
+template<class T>
+static std::vector<any> Interleaved()
+{
+	std::vector<any> values;
+	for (int i = 0; i < batch; ++i)
+	{
+		i % 2 ? values.emplace_back(i) : values.emplace_back(T{});
+	}
+	return values;
+}
+
+template<class T>
+static void BM_GatherCast(benchmark::State& state)
+{
+	const std::vector<any> values = Interleaved<T>();
+	std::vector<T> out(batch);
+
+	for (auto _ : state)
+	{
+		T* next = out.data();
+		for (const any& value : values)
+		{
+			if (const T* t = any_cast<T>(&value))
+			{
+				*next++ = *t;
+			}
+		}
+		benchmark::DoNotOptimize(next);
+	}
+
+	state.SetItemsProcessed(state.iterations() * batch);
+}
+
+template<class T>
+static void BM_GatherBatch(benchmark::State& state)
+{
+	const std::vector<any> values = Interleaved<T>();
+	std::vector<T> out(batch);
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(any_gather<T>(values, out.data()));
+	}
+
+	state.SetItemsProcessed(state.iterations() * batch);
+}
+
+template<class Any, class T>
+void RegisterOperations(const std::string& suffix)
+{
+	benchmark::RegisterBenchmark(("Construct/" + suffix).c_str(), BM_Construct<Any, T>);
+	benchmark::RegisterBenchmark(("Copy/" + suffix).c_str(), BM_Copy<Any, T>);
+	benchmark::RegisterBenchmark(("Move/" + suffix).c_str(), BM_Move<Any, T>);
+	benchmark::RegisterBenchmark(("Swap/" + suffix).c_str(), BM_Swap<Any, T>);
+	benchmark::RegisterBenchmark(("Emplace/" + suffix).c_str(), BM_Emplace<Any, T>);
+	benchmark::RegisterBenchmark(("Reset/" + suffix).c_str(), BM_Reset<Any, T>);
+	benchmark::RegisterBenchmark(("CastHit/" + suffix).c_str(), BM_CastHit<Any, T>);
+	benchmark::RegisterBenchmark(("CastMiss/" + suffix).c_str(), BM_CastMiss<Any, T>);
+	benchmark::RegisterBenchmark(("VectorPushBack/" + suffix).c_str(), BM_VectorPushBack<Any, T>);
+	benchmark::RegisterBenchmark(("VectorSort/" + suffix).c_str(), BM_VectorSort<Any, T>);
+	benchmark::RegisterBenchmark(("VectorAssign/" + suffix).c_str(), BM_VectorAssign<Any, T>);
+}
+
+template<class T>
+void RegisterPayload()
+{
+	const std::string shape = std::to_string(sizeof(T)) + "x" + std::to_string(alignof(T));
+
+	RegisterOperations<any, T>("any/" + shape);
+	benchmark::RegisterBenchmark(("VectorAssign/any_copy/" + shape).c_str(), BM_VectorAssignBatch<T>);
+	benchmark::RegisterBenchmark(("Sum/any_cast/" + shape).c_str(), BM_SumCast<any, T>);
+	benchmark::RegisterBenchmark(("Sum/cache_line_any/" + shape).c_str(), BM_SumCast<cache_line_any, T>);
+	benchmark::RegisterBenchmark(("Sum/any_cast_unchecked/" + shape).c_str(), BM_SumUnchecked<T>);
+	benchmark::RegisterBenchmark(("Gather/any_cast/" + shape).c_str(), BM_GatherCast<T>);
+	benchmark::RegisterBenchmark(("Gather/any_gather/" + shape).c_str(), BM_GatherBatch<T>);
+	RegisterOperations<compact_any, T>("compact_any/" + shape);
+	RegisterOperations<std::any, T>("std::any/" + shape);
+#if ANY_BENCH_HAS_BOOST
+	RegisterOperations<boost::any, T>("boost::any/" + shape);
+#endif
+}
+
+template<size_t N>
+struct Alternative
+{
+	int value = static_cast<int>(N);
+};
+
+// The value is always the last alternative, the worst case for the chain.
+template<size_t... Is>
+static void BM_DispatchChain(benchmark::State& state, std::index_sequence<Is...>)
+{
+	any a = Alternative<sizeof...(Is) - 1>{};
+
+	for (auto _ : state)
+	{
+		int result = -1;
+		((Cast<Alternative<Is>>(a) ? (result = Cast<Alternative<Is>>(a)->value, true) : false) || ...);
+		benchmark::DoNotOptimize(result);
+	}
+}
+
+template<size_t... Is>
+static void BM_DispatchVisit(benchmark::State& state, std::index_sequence<Is...>)
+{
+	any a = Alternative<sizeof...(Is) - 1>{};
+
+	for (auto _ : state)
+	{
+		int result = any_visit<Alternative<Is>...>([](auto& alternative) { return alternative.value; }, a);
+		benchmark::DoNotOptimize(result);
+	}
+}
+
+template<size_t... Is>
+static void BM_DispatchAnyOf(benchmark::State& state, std::index_sequence<Is...>)
+{
+	any_of<Alternative<Is>...> a = Alternative<sizeof...(Is) - 1>{};
+
+	for (auto _ : state)
+	{
+		int result = a.visit([](auto& alternative) { return alternative.value; });
+		benchmark::DoNotOptimize(result);
+	}
+}
+
+template<size_t N>
+void RegisterDispatch()
+{
+	benchmark::RegisterBenchmark(("Dispatch/chain/" + std::to_string(N)).c_str(), [](benchmark::State& state) { BM_DispatchChain(state, std::make_index_sequence<N>{}); });
+	benchmark::RegisterBenchmark(("Dispatch/any_visit/" + std::to_string(N)).c_str(), [](benchmark::State& state) { BM_DispatchVisit(state, std::make_index_sequence<N>{}); });
+	benchmark::RegisterBenchmark(("Dispatch/any_of/" + std::to_string(N)).c_str(), [](benchmark::State& state) { BM_DispatchAnyOf(state, std::make_index_sequence<N>{}); });
+}
+
+// Below, at and above small_space_size, and above small_space_align.
+static const bool registered = []
+{
+	RegisterPayload<Payload<8, 8>>();
+	RegisterPayload<Payload<32, 8>>();
+	RegisterPayload<Payload<small_space_size, 8>>();
+	RegisterPayload<Payload<small_space_size + 8, 8>>();
+	RegisterPayload<Payload<256, 8>>();
+	RegisterPayload<Payload<16, 16>>();
+	RegisterPayload<Payload<32, 32>>();
+	RegisterPayload<Payload<64, 64>>();
+
+	RegisterDispatch<2>();
+	RegisterDispatch<8>();
+	RegisterDispatch<32>();
+	return true;
+}();
+
+BENCHMARK_MAIN();
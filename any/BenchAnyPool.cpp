@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+#include "any.h"
+#include <array>
+#include <vector>
+
+/*
+	Big-path throughput with the thread-local pool (the default any) versus the plain global heap.
+	Each iteration constructs and destroys a batch of big values, run with 1..32 threads to see how both scale.
+*/
+
+using heap_any = basic_any<small_space_size, small_space_align, any_heap_allocator>;
+using pool_any = basic_any<small_space_size, small_space_align, any_pool_allocator>;
+
+template<size_t Size>
+struct Payload
+{
+	std::array<char, Size> data;
+};
+
+template<class Any, size_t Size>
+static void BM_BigConstructDestroy(benchmark::State& state)
+{
+	constexpr int batch = 64;
+	std::vector<Any> va(batch);
+
+	for (auto _ : state)
+	{
+		for (auto& a : va)
+		{
+			a.template emplace<Payload<Size>>();
+		}
+		for (auto& a : va)
+		{
+			a.reset();
+		}
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * batch);
+}
+
+// A mix of the sizes that spill: 72..512 bytes.
+template<class Any>
+static void BM_BigMixedSizes(benchmark::State& state)
+{
+	constexpr int batch = 64;
+	std::vector<Any> va(batch);
+
+	for (auto _ : state)
+	{
+		for (int i = 0; i < batch; ++i)
+		{
+			switch (i % 4)
+			{
+			case 0: va[i].template emplace<Payload<72>>(); break;
+			case 1: va[i].template emplace<Payload<128>>(); break;
+			case 2: va[i].template emplace<Payload<256>>(); break;
+			case 3: va[i].template emplace<Payload<512>>(); break;
+			}
+		}
+		for (auto& a : va)
+		{
+			a.reset();
+		}
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * batch);
+}
+
+BENCHMARK_TEMPLATE(BM_BigConstructDestroy, heap_any, 72)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BigConstructDestroy, pool_any, 72)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BigConstructDestroy, heap_any, 512)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BigConstructDestroy, pool_any, 512)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BigMixedSizes, heap_any)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BigMixedSizes, pool_any)->ThreadRange(1, 32)->UseRealTime();
+
+BENCHMARK_MAIN();
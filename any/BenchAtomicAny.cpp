@@ -0,0 +1,131 @@
+#include <benchmark/benchmark.h>
+#include "atomic_any.h"
+#include <array>
+#include <memory>
+#include <mutex>
+
+/*
+	Reading a shared configuration from 1..32 threads: atomic_any next to an any behind a mutex and a
+	std::shared_ptr<const any> read with std::atomic_load.
+	Every read takes a consistent view of the value and touches one field of it. The ReadWhileWriting variants have
+	thread 0 publish a new value on every iteration while the others read.
+*/
+
+struct Config
+{
+	std::array<int, 32> values{};
+};
+
+class AtomicAnyConfig
+{
+public:
+	int Read() const
+	{
+		atomic_any::snapshot s = _value.load();
+		return any_cast<const Config&>(*s).values[7];
+	}
+
+	void Write(int v)
+	{
+		Config c;
+		c.values[7] = v;
+		_value.store(c);
+	}
+
+private:
+	atomic_any _value{ Config{} };
+};
+
+class MutexConfig
+{
+public:
+	int Read() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return any_cast<const Config&>(_value).values[7];
+	}
+
+	void Write(int v)
+	{
+		Config c;
+		c.values[7] = v;
+		any value = c;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_value.swap(value);
+	}
+
+private:
+	mutable std::mutex _mutex;
+	any _value = Config{};
+};
+
+class SharedPtrConfig
+{
+public:
+	int Read() const
+	{
+		std::shared_ptr<const any> s = std::atomic_load(&_value);
+		return any_cast<const Config&>(*s).values[7];
+	}
+
+	void Write(int v)
+	{
+		Config c;
+		c.values[7] = v;
+		std::atomic_store(&_value, std::make_shared<const any>(c));
+	}
+
+private:
+	std::shared_ptr<const any> _value = std::make_shared<const any>(Config{});
+};
+
+template<class Shared>
+static Shared& Instance()
+{
+	static Shared shared;
+	return shared;
+}
+
+template<class Shared>
+static void BM_Read(benchmark::State& state)
+{
+	const Shared& shared = Instance<Shared>();
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(shared.Read());
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+template<class Shared>
+static void BM_ReadWhileWriting(benchmark::State& state)
+{
+	Shared& shared = Instance<Shared>();
+	int version = 0;
+
+	for (auto _ : state)
+	{
+		if (state.thread_index() == 0)
+		{
+			shared.Write(++version);
+		}
+		else
+		{
+			benchmark::DoNotOptimize(shared.Read());
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_Read, AtomicAnyConfig)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Read, MutexConfig)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Read, SharedPtrConfig)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadWhileWriting, AtomicAnyConfig)->ThreadRange(2, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadWhileWriting, MutexConfig)->ThreadRange(2, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadWhileWriting, SharedPtrConfig)->ThreadRange(2, 32)->UseRealTime();
+
+BENCHMARK_MAIN();
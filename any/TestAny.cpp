@@ -1,409 +1,483 @@
-#include <gtest/gtest.h>
-#include "any.h"
-#include <numeric>
-#include <any>
-#include "TestObject.h"
-
-__declspec(align(16))
-struct Align16
-{
-	explicit Align16(int x = 16) : mX(x) {}
-	int mX;
-};
-
-inline bool operator==(const Align16& a, const Align16& b)
-{
-	return (a.mX == b.mX);
-}
-
-__declspec(align(32))
-struct Align32
-{
-	explicit Align32(int x = 32) : mX(x) {}
-	int mX;
-};
-
-inline bool operator==(const Align32& a, const Align32& b)
-{
-	return (a.mX == b.mX);
-}
-
-__declspec(align(64))
-struct Align64
-{
-	explicit Align64(int x = 64) : mX(x) {}
-	int mX;
-};
-
-inline bool operator==(const Align64& a, const Align64& b)
-{
-	return (a.mX == b.mX);
-}
-
-struct SmallTestObject
-{
-	static int mCtorCount;
-
-	SmallTestObject() noexcept { mCtorCount++; }
-	SmallTestObject(const SmallTestObject&) noexcept { mCtorCount++; }
-	SmallTestObject(SmallTestObject&&) noexcept { mCtorCount++; }
-	SmallTestObject& operator=(const SmallTestObject&) noexcept { mCtorCount++; return *this; }
-	~SmallTestObject() noexcept { mCtorCount--; }
-
-	static void Reset() { mCtorCount = 0; }
-	static bool IsClear() { return mCtorCount == 0; }
-};
-
-int SmallTestObject::mCtorCount = 0;
-
-struct RequiresInitList
-{
-	RequiresInitList(std::initializer_list<int> ilist)
-		: sum(std::accumulate(begin(ilist), end(ilist), 0)) {}
-
-	int sum;
-};
-
-
-TEST(CtorTests, GivenEmptyAny_DefaultConstructorWorks)
-{
-	any a;
-	EXPECT_FALSE(a.has_value());
-}
-
-TEST(CtorTests, GivenSmallTestObject_CtorsAndDtorsAreCalledForSmallObject)
-{
-	SmallTestObject::Reset();
-	{
-		any a{ SmallTestObject() };
-	}
-	EXPECT_TRUE(SmallTestObject::IsClear());
-}
-
-TEST(CtorTests, GivenTestObject_CtorsAndDtorsAreCalled)
-{
-	TestObject::Reset();
-	{
-		any a{ TestObject() };
-	}
-	EXPECT_TRUE(TestObject::IsClear());
-}
-
-TEST(CtorTests, GivenNonEmptyAny_HasValue)
-{
-	any a(42);
-
-	EXPECT_TRUE(a.has_value());
-}
-
-TEST(DtorTests, GivenNonEmptyObjects_DtorIsCalledAfterSwappingRepresentation)
-{
-	TestObject::Reset();
-	{
-		any a(42);
-		any b{ TestObject() };
-
-		b.swap(a);
-	}
-	EXPECT_TRUE(TestObject::IsClear());
-}
-
-
-TEST(CtorTests, GivenNonEmptyAny_SmallRepresentationCastToBigRepresentationWorks)
-{
-	any intAny = 3333u;
-
-	EXPECT_EQ(any_cast<unsigned>(intAny), 3333u);
-
-	intAny = TestObject(33333);
-
-	EXPECT_EQ(any_cast<TestObject>(intAny).mX, 33333);
-}
-
-TEST(CtorTests, GivenNonEmptyAny_EqualsOperatorWorks)
-{
-	any a1 = 42;
-	any a2 = a1;
-
-	EXPECT_TRUE(a1.has_value());
-	EXPECT_TRUE(a2.has_value());
-	EXPECT_EQ(any_cast<int>(a1), any_cast<int>(a2));
-}
-
-TEST(CtorTests, GivenNonEmptyStringAny_ValueIsCorrect)
-{
-	any a(std::string("test string"));
-	EXPECT_TRUE(a.has_value());
-	EXPECT_EQ(any_cast<std::string>(a), "test string");
-}
-
-TEST(CtorTests, GivenEmptyAny_ConstructingTheAnyFromAScopeConstructedAnyWorks)
-{
-	any a1;
-	EXPECT_FALSE(a1.has_value());
-
-	{
-		any a2(std::string("test string"));
-		a1 = any_cast<std::string>(a2);
-
-		EXPECT_TRUE(a1.has_value());
-	}
-
-	EXPECT_EQ(any_cast<std::string>(a1), "test string");
-	EXPECT_TRUE(a1.has_value());
-}
-
-TEST(CtorTests, TT)
-{
-	any a1;
-	EXPECT_FALSE(a1.has_value());
-
-	{
-		any a2(std::string("test string"));
-		a1 = a2;
-		EXPECT_TRUE(a1.has_value());
-	}
-
-	EXPECT_EQ(any_cast<std::string&>(a1), "test string");
-	EXPECT_TRUE(a1.has_value());
-}
-
-TEST(CtorTests, GivenAlignedTypes_AnyConstructsWithRequestedAlignment)
-{
-	{
-		any a = Align16(1337);
-		EXPECT_TRUE(any_cast<Align16>(a) == Align16(1337));
-	}
-
-	{
-		any a = Align32(1337);
-		EXPECT_TRUE(any_cast<Align32>(a) == Align32(1337));
-	}
-
-	{
-		any a = Align64(1337);
-		EXPECT_TRUE(any_cast<Align64>(a) == Align64(1337));
-	}
-}
-
-TEST(CtorTests, GivenFloat_AnyCtorDeducesTheTypeCorrectly)
-{
-	float f = 42.f;
-	any a(f);
-	EXPECT_EQ(any_cast<float>(a), 42.f);
-}
-
-TEST(AnyCastsTest, GivenNonEmptyAny_AnyCastReturnsExpectedValue)
-{
-	any a(42);
-
-	EXPECT_EQ(any_cast<int>(a), 42);
-}
-
-TEST(AnyCastsTest, GivenNonEmptyAny_AnyCastHoldsExpectedValue)
-{
-	any a(42);
-
-	EXPECT_NE(any_cast<int>(a), 1337);
-}
-
-TEST(AnyCastsTest, GivenNonEmptyAny_AnyCastingModifiesTheValue)
-{
-	any a(42);
-
-	any_cast<int&>(a) = 10;
-	EXPECT_EQ(any_cast<int>(a), 10);
-}
-
-TEST(AnyCastsTest, GivenNonEmptyFloatAny_AnyCastingModifiesTheValue)
-{
-	any a(1.f);
-
-	any_cast<float&>(a) = 1337.f;
-	EXPECT_EQ(any_cast<float>(a), 1337.f);
-}
-
-TEST(AnyCastsTest, GivenNonEmptyStringAny_AnyCastingModifiesTheValue)
-{
-	any a(std::string("hello world"));
-
-	EXPECT_EQ(any_cast<std::string>(a), "hello world");
-	EXPECT_EQ(any_cast<std::string&>(a), "hello world");
-}
-
-TEST(AnyCastsTest, GivenNonEmptyCustomType_AnyCastingModifiesTheValue)
-{
-	struct custom_type { int data; };
-
-	any a = custom_type{};
-	any_cast<custom_type&>(a).data = 42;
-	EXPECT_EQ(any_cast<custom_type>(a).data, 42);
-}
-
-TEST(AnyCastsTest, GivenNonEmptyAny_AnyCastingToDifferentTypeThrows)
-{
-	any a = 42;
-	EXPECT_EQ(any_cast<int>(a), 42);
-
-	EXPECT_ANY_THROW((any_cast<short>(a), 42));
-}
-
-TEST(AnyCastsTest, GivenNonEmptyAnyVector_AnyCastsTestSuccessfullyToExpectedTypes)
-{
-	std::vector<any> va = { 42, 'a', 42.f, 3333u, 4444ul, 5555ull, 6666.0, std::string("dolhasca") };
-
-	EXPECT_EQ(any_cast<int>(va[0]), 42);
-	EXPECT_EQ(any_cast<char>(va[1]), 'a');
-	EXPECT_EQ(any_cast<float>(va[2]), 42.f);
-	EXPECT_EQ(any_cast<unsigned>(va[3]), 3333u);
-	EXPECT_EQ(any_cast<unsigned long>(va[4]), 4444ul);
-	EXPECT_EQ(any_cast<unsigned long long>(va[5]), 5555ull);
-	EXPECT_EQ(any_cast<double>(va[6]), 6666.0);
-	EXPECT_EQ(any_cast<std::string>(va[7]), "dolhasca");
-}
-
-TEST(AnyCastsTest, GivenEmptyAnyVector_AnyCastsTestSuccessfulyAfterPushBack)
-{
-	std::vector<std::any> va;
-	va.push_back(42);
-	va.push_back(std::string("rob"));
-	va.push_back('a');
-	va.push_back(42.f);
-
-	EXPECT_EQ(any_cast<int>(va[0]), 42);
-	EXPECT_EQ(any_cast<std::string>(va[1]), "rob");
-	EXPECT_EQ(any_cast<char>(va[2]), 'a');
-	EXPECT_EQ(any_cast<float>(va[3]), 42.f);
-}
-
-TEST(AnyCastsTest, GivenSmallAnyObject_ReplacingItWithALargerOneDoesntCorrputTheSurroundingMemory)
-{
-	TestObject::Reset();
-	{
-		std::vector<any> va = { 42, 'a', 42.f, 3333u, 4444ul, 5555ull, 6666.0 };
-
-		EXPECT_EQ(any_cast<int>(va[0]), 42);
-		EXPECT_EQ(any_cast<char>(va[1]), 'a');
-		EXPECT_EQ(any_cast<float>(va[2]), 42.f);
-		EXPECT_EQ(any_cast<unsigned>(va[3]), 3333u);
-		EXPECT_EQ(any_cast<unsigned long>(va[4]), 4444ul);
-		EXPECT_EQ(any_cast<unsigned long long>(va[5]), 5555ull);
-		EXPECT_EQ(any_cast<double>(va[6]), 6666.0);
-
-		va[3] = TestObject(3333); // replace a small integral with a large heap allocated object.
-
-		EXPECT_EQ(any_cast<int>(va[0]), 42);
-		EXPECT_EQ(any_cast<char>(va[1]), 'a');
-		EXPECT_EQ(any_cast<float>(va[2]), 42.f);
-		EXPECT_EQ(any_cast<TestObject>(va[3]).mX, 3333); // not 3333u because TestObject ctor takes a signed type.
-		EXPECT_EQ(any_cast<unsigned long>(va[4]), 4444ul);
-		EXPECT_EQ(any_cast<unsigned long long>(va[5]), 5555ull);
-		EXPECT_EQ(any_cast<double>(va[6]), 6666.0);
-	}
-}
-
-TEST(AnyCasts, GivenNonEmptyAny_EquivalenceCastsWorkAsExpected)
-{
-	any a, b;
-	EXPECT_TRUE(!a.has_value() == !b.has_value());
-
-	EXPECT_ANY_THROW(any_cast<int>(a) == any_cast<int>(b));
-
-	a = 42; b = 24;
-	EXPECT_TRUE(any_cast<int>(a) != any_cast<int>(b));
-	EXPECT_TRUE(a.has_value() == b.has_value());
-
-	a = 42; b = 42;
-	EXPECT_TRUE(any_cast<int>(a) == any_cast<int>(b));
-	EXPECT_TRUE(a.has_value() == b.has_value());
-}
-
-TEST(AnyCastsTest, GivenEmptyAny_CastsReturnNullptr)
-{
-	any* a = nullptr;
-	EXPECT_TRUE(any_cast<int>(a) == nullptr);
-	EXPECT_TRUE(any_cast<short>(a) == nullptr);
-	EXPECT_TRUE(any_cast<long>(a) == nullptr);
-	EXPECT_TRUE(any_cast<std::string>(a) == nullptr);
-
-	any b;
-	EXPECT_TRUE(any_cast<short>(&b) == nullptr);
-	EXPECT_TRUE(any_cast<const short>(&b) == nullptr);
-	EXPECT_TRUE(any_cast<volatile short>(&b) == nullptr);
-	EXPECT_TRUE(any_cast<const volatile short>(&b) == nullptr);
-
-	EXPECT_TRUE(any_cast<short*>(&b) == nullptr);
-	EXPECT_TRUE(any_cast<const short*>(&b) == nullptr);
-	EXPECT_TRUE(any_cast<volatile short*>(&b) == nullptr);
-	EXPECT_TRUE(any_cast<const volatile short*>(&b) == nullptr);
-}
-
-TEST(EmplaceTests, GivenEmptyAny_EmplacingSmallObjectsWorks)
-{
-	any a;
-
-	a.emplace<int>(42);
-	EXPECT_TRUE(a.has_value());
-	EXPECT_EQ(any_cast<int>(a), 42);
-
-	a.emplace<short>((short)8); // no way to define a short literal we must cast here.
-	EXPECT_EQ(any_cast<short>(a), 8);
-	EXPECT_TRUE(a.has_value());
-
-	a.reset();
-	EXPECT_FALSE(a.has_value());
-}
-
-TEST(EmplaceTests, GivenEmptyAny_EmplacingLargeObjects_Works)
-{
-	TestObject::Reset();
-	{
-		any a;
-		a.emplace<TestObject>();
-		EXPECT_TRUE(a.has_value());
-	}
-	EXPECT_TRUE(TestObject::IsClear());
-}
-
-TEST(EmplaceTests, GivenEmptyAny_EmplaceInitializingThroughInitializerList_Works)
-{
-	{
-		any a;
-		a.emplace<RequiresInitList>(std::initializer_list<int>{1, 2, 3, 4, 5, 6});
-
-		EXPECT_TRUE(a.has_value());
-		EXPECT_EQ(any_cast<RequiresInitList>(a).sum, 21);
-	}
-}
-
-TEST(SwapTests, GivenNonEmptyAny_AnySwapWorks)
-{
-	any a1 = 42;
-	any a2 = 24;
-	EXPECT_EQ(any_cast<int>(a1), 42);
-	EXPECT_EQ(any_cast<int>(a2), 24);
-
-	a1.swap(a2);
-	EXPECT_EQ(any_cast<int>(a1), 24);
-	EXPECT_EQ(any_cast<int>(a2), 42);
-}
-
-TEST(SwapTests, GivenNonEmptyAny_STDSwapWorksOnAny)
-{
-	any a1 = 42;
-	any a2 = 24;
-
-	EXPECT_EQ(any_cast<int>(a1), 42);
-	EXPECT_EQ(any_cast<int>(a2), 24);
-
-	std::swap(a1, a2);
-
-	EXPECT_EQ(any_cast<int>(a1), 24);
-	EXPECT_EQ(any_cast<int>(a2), 42);
-}
-
-TEST(SwapTests, GivenNonEmptyListAny_SwapWorksAsExpected)
-{
+#include <gtest/gtest.h>
+#include "any.h"
+#include <numeric>
+#include <array>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include <memory_resource>
+#include <any>
+#include "TestObject.h"
+
+struct alignas(16) Align16
+{
+	explicit Align16(int x = 16) : mX(x) {}
+	int mX;
+};
+
+inline bool operator==(const Align16& a, const Align16& b)
+{
+	return (a.mX == b.mX);
+}
+
+struct alignas(32) Align32
+{
+	explicit Align32(int x = 32) : mX(x) {}
+	int mX;
+};
+
+inline bool operator==(const Align32& a, const Align32& b)
+{
+	return (a.mX == b.mX);
+}
+
+struct alignas(64) Align64
+{
+	explicit Align64(int x = 64) : mX(x) {}
+	int mX;
+};
+
+inline bool operator==(const Align64& a, const Align64& b)
+{
+	return (a.mX == b.mX);
+}
+
+struct SmallTestObject
+{
+	static int mCtorCount;
+
+	SmallTestObject() noexcept { mCtorCount++; }
+	SmallTestObject(const SmallTestObject&) noexcept { mCtorCount++; }
+	SmallTestObject(SmallTestObject&&) noexcept { mCtorCount++; }
+	SmallTestObject& operator=(const SmallTestObject&) noexcept { mCtorCount++; return *this; }
+	~SmallTestObject() noexcept { mCtorCount--; }
+
+	static void Reset() { mCtorCount = 0; }
+	static bool IsClear() { return mCtorCount == 0; }
+};
+
+int SmallTestObject::mCtorCount = 0;
+
+struct RequiresInitList
+{
+	RequiresInitList(std::initializer_list<int> ilist)
+		: sum(std::accumulate(begin(ilist), end(ilist), 0)) {}
+
+	int sum;
+};
+
+
+TEST(CtorTests, GivenEmptyAny_DefaultConstructorWorks)
+{
+	any a;
+	EXPECT_FALSE(a.has_value());
+}
+
+TEST(CtorTests, GivenSmallTestObject_CtorsAndDtorsAreCalledForSmallObject)
+{
+	SmallTestObject::Reset();
+	{
+		any a{ SmallTestObject() };
+	}
+	EXPECT_TRUE(SmallTestObject::IsClear());
+}
+
+TEST(CtorTests, GivenTestObject_CtorsAndDtorsAreCalled)
+{
+	TestObject::Reset();
+	{
+		any a{ TestObject() };
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(CtorTests, GivenNonEmptyAny_HasValue)
+{
+	any a(42);
+
+	EXPECT_TRUE(a.has_value());
+}
+
+TEST(DtorTests, GivenNonEmptyObjects_DtorIsCalledAfterSwappingRepresentation)
+{
+	TestObject::Reset();
+	{
+		any a(42);
+		any b{ TestObject() };
+
+		b.swap(a);
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+
+TEST(CtorTests, GivenNonEmptyAny_SmallRepresentationCastToBigRepresentationWorks)
+{
+	any intAny = 3333u;
+
+	EXPECT_EQ(any_cast<unsigned>(intAny), 3333u);
+
+	intAny = TestObject(33333);
+
+	EXPECT_EQ(any_cast<TestObject>(intAny).mX, 33333);
+}
+
+TEST(CtorTests, GivenNonEmptyAny_EqualsOperatorWorks)
+{
+	any a1 = 42;
+	any a2 = a1;
+
+	EXPECT_TRUE(a1.has_value());
+	EXPECT_TRUE(a2.has_value());
+	EXPECT_EQ(any_cast<int>(a1), any_cast<int>(a2));
+}
+
+TEST(CtorTests, GivenNonEmptyStringAny_ValueIsCorrect)
+{
+	any a(std::string("test string"));
+	EXPECT_TRUE(a.has_value());
+	EXPECT_EQ(any_cast<std::string>(a), "test string");
+}
+
+TEST(CtorTests, GivenEmptyAny_ConstructingTheAnyFromAScopeConstructedAnyWorks)
+{
+	any a1;
+	EXPECT_FALSE(a1.has_value());
+
+	{
+		any a2(std::string("test string"));
+		a1 = any_cast<std::string>(a2);
+
+		EXPECT_TRUE(a1.has_value());
+	}
+
+	EXPECT_EQ(any_cast<std::string>(a1), "test string");
+	EXPECT_TRUE(a1.has_value());
+}
+
+TEST(CtorTests, TT)
+{
+	any a1;
+	EXPECT_FALSE(a1.has_value());
+
+	{
+		any a2(std::string("test string"));
+		a1 = a2;
+		EXPECT_TRUE(a1.has_value());
+	}
+
+	EXPECT_EQ(any_cast<std::string&>(a1), "test string");
+	EXPECT_TRUE(a1.has_value());
+}
+
+TEST(CtorTests, GivenAlignedTypes_AnyConstructsWithRequestedAlignment)
+{
+	{
+		any a = Align16(1337);
+		EXPECT_TRUE(any_cast<Align16>(a) == Align16(1337));
+	}
+
+	{
+		any a = Align32(1337);
+		EXPECT_TRUE(any_cast<Align32>(a) == Align32(1337));
+	}
+
+	{
+		any a = Align64(1337);
+		EXPECT_TRUE(any_cast<Align64>(a) == Align64(1337));
+	}
+}
+
+template<class T, class Any>
+bool IsStoredInline(const Any& a)
+{
+	auto object = reinterpret_cast<const char*>(any_cast<T>(&a));
+	auto begin = reinterpret_cast<const char*>(&a);
+
+	return object >= begin && object + sizeof(T) <= begin + sizeof(Any);
+}
+
+template<class T>
+bool IsAligned(const T* p)
+{
+	return reinterpret_cast<std::uintptr_t>(p) % alignof(T) == 0;
+}
+
+TEST(CtorTests, GivenAlignedTypes_AlignedAnyStoresThemInlineWithRequestedAlignment)
+{
+	{
+		aligned_any<16> a = Align16(1337);
+		EXPECT_TRUE(any_cast<Align16>(a) == Align16(1337));
+		EXPECT_TRUE(IsStoredInline<Align16>(a));
+		EXPECT_TRUE(IsAligned(any_cast<Align16>(&a)));
+	}
+
+	{
+		aligned_any<32> a = Align32(1337);
+		EXPECT_TRUE(any_cast<Align32>(a) == Align32(1337));
+		EXPECT_TRUE(IsStoredInline<Align32>(a));
+		EXPECT_TRUE(IsAligned(any_cast<Align32>(&a)));
+	}
+
+	{
+		aligned_any<64> a = Align64(1337);
+		EXPECT_TRUE(any_cast<Align64>(a) == Align64(1337));
+		EXPECT_TRUE(IsStoredInline<Align64>(a));
+		EXPECT_TRUE(IsAligned(any_cast<Align64>(&a)));
+
+		aligned_any<64> b = a;
+		EXPECT_TRUE(IsStoredInline<Align64>(b));
+		EXPECT_TRUE(IsAligned(any_cast<Align64>(&b)));
+	}
+
+	{
+		std::vector<aligned_any<32>> va(3, Align32(1337));
+		va.emplace_back(Align32(42));
+
+		for (auto& a : va)
+		{
+			EXPECT_TRUE(IsStoredInline<Align32>(a));
+			EXPECT_TRUE(IsAligned(any_cast<Align32>(&a)));
+		}
+		EXPECT_TRUE(any_cast<Align32>(va.back()) == Align32(42));
+	}
+}
+
+TEST(CtorTests, GivenOverAlignedType_MovingItToAnAlignedAnyStoresItInline)
+{
+	any a = Align32(1337);
+	EXPECT_FALSE(IsStoredInline<Align32>(a));
+	EXPECT_TRUE(IsAligned(any_cast<Align32>(&a)));
+
+	aligned_any<32> b = std::move(a);
+	EXPECT_FALSE(a.has_value());
+	EXPECT_TRUE(IsStoredInline<Align32>(b));
+	EXPECT_TRUE(any_cast<Align32>(b) == Align32(1337));
+}
+
+TEST(CtorTests, GivenFloat_AnyCtorDeducesTheTypeCorrectly)
+{
+	float f = 42.f;
+	any a(f);
+	EXPECT_EQ(any_cast<float>(a), 42.f);
+}
+
+TEST(AnyCastsTest, GivenNonEmptyAny_AnyCastReturnsExpectedValue)
+{
+	any a(42);
+
+	EXPECT_EQ(any_cast<int>(a), 42);
+}
+
+TEST(AnyCastsTest, GivenNonEmptyAny_AnyCastHoldsExpectedValue)
+{
+	any a(42);
+
+	EXPECT_NE(any_cast<int>(a), 1337);
+}
+
+TEST(AnyCastsTest, GivenNonEmptyAny_AnyCastingModifiesTheValue)
+{
+	any a(42);
+
+	any_cast<int&>(a) = 10;
+	EXPECT_EQ(any_cast<int>(a), 10);
+}
+
+TEST(AnyCastsTest, GivenNonEmptyFloatAny_AnyCastingModifiesTheValue)
+{
+	any a(1.f);
+
+	any_cast<float&>(a) = 1337.f;
+	EXPECT_EQ(any_cast<float>(a), 1337.f);
+}
+
+TEST(AnyCastsTest, GivenNonEmptyStringAny_AnyCastingModifiesTheValue)
+{
+	any a(std::string("hello world"));
+
+	EXPECT_EQ(any_cast<std::string>(a), "hello world");
+	EXPECT_EQ(any_cast<std::string&>(a), "hello world");
+}
+
+TEST(AnyCastsTest, GivenNonEmptyCustomType_AnyCastingModifiesTheValue)
+{
+	struct custom_type { int data; };
+
+	any a = custom_type{};
+	any_cast<custom_type&>(a).data = 42;
+	EXPECT_EQ(any_cast<custom_type>(a).data, 42);
+}
+
+TEST(AnyCastsTest, GivenNonEmptyAny_AnyCastingToDifferentTypeThrows)
+{
+	any a = 42;
+	EXPECT_EQ(any_cast<int>(a), 42);
+
+	EXPECT_ANY_THROW((any_cast<short>(a), 42));
+}
+
+TEST(AnyCastsTest, GivenNonEmptyAnyVector_AnyCastsTestSuccessfullyToExpectedTypes)
+{
+	std::vector<any> va = { 42, 'a', 42.f, 3333u, 4444ul, 5555ull, 6666.0, std::string("dolhasca") };
+
+	EXPECT_EQ(any_cast<int>(va[0]), 42);
+	EXPECT_EQ(any_cast<char>(va[1]), 'a');
+	EXPECT_EQ(any_cast<float>(va[2]), 42.f);
+	EXPECT_EQ(any_cast<unsigned>(va[3]), 3333u);
+	EXPECT_EQ(any_cast<unsigned long>(va[4]), 4444ul);
+	EXPECT_EQ(any_cast<unsigned long long>(va[5]), 5555ull);
+	EXPECT_EQ(any_cast<double>(va[6]), 6666.0);
+	EXPECT_EQ(any_cast<std::string>(va[7]), "dolhasca");
+}
+
+TEST(AnyCastsTest, GivenEmptyAnyVector_AnyCastsTestSuccessfulyAfterPushBack)
+{
+	std::vector<std::any> va;
+	va.push_back(42);
+	va.push_back(std::string("rob"));
+	va.push_back('a');
+	va.push_back(42.f);
+
+	EXPECT_EQ(any_cast<int>(va[0]), 42);
+	EXPECT_EQ(any_cast<std::string>(va[1]), "rob");
+	EXPECT_EQ(any_cast<char>(va[2]), 'a');
+	EXPECT_EQ(any_cast<float>(va[3]), 42.f);
+}
+
+TEST(AnyCastsTest, GivenSmallAnyObject_ReplacingItWithALargerOneDoesntCorrputTheSurroundingMemory)
+{
+	TestObject::Reset();
+	{
+		std::vector<any> va = { 42, 'a', 42.f, 3333u, 4444ul, 5555ull, 6666.0 };
+
+		EXPECT_EQ(any_cast<int>(va[0]), 42);
+		EXPECT_EQ(any_cast<char>(va[1]), 'a');
+		EXPECT_EQ(any_cast<float>(va[2]), 42.f);
+		EXPECT_EQ(any_cast<unsigned>(va[3]), 3333u);
+		EXPECT_EQ(any_cast<unsigned long>(va[4]), 4444ul);
+		EXPECT_EQ(any_cast<unsigned long long>(va[5]), 5555ull);
+		EXPECT_EQ(any_cast<double>(va[6]), 6666.0);
+
+		va[3] = TestObject(3333); // replace a small integral with a large heap allocated object.
+
+		EXPECT_EQ(any_cast<int>(va[0]), 42);
+		EXPECT_EQ(any_cast<char>(va[1]), 'a');
+		EXPECT_EQ(any_cast<float>(va[2]), 42.f);
+		EXPECT_EQ(any_cast<TestObject>(va[3]).mX, 3333); // not 3333u because TestObject ctor takes a signed type.
+		EXPECT_EQ(any_cast<unsigned long>(va[4]), 4444ul);
+		EXPECT_EQ(any_cast<unsigned long long>(va[5]), 5555ull);
+		EXPECT_EQ(any_cast<double>(va[6]), 6666.0);
+	}
+}
+
+TEST(AnyCasts, GivenNonEmptyAny_EquivalenceCastsWorkAsExpected)
+{
+	any a, b;
+	EXPECT_TRUE(!a.has_value() == !b.has_value());
+
+	EXPECT_ANY_THROW(any_cast<int>(a) == any_cast<int>(b));
+
+	a = 42; b = 24;
+	EXPECT_TRUE(any_cast<int>(a) != any_cast<int>(b));
+	EXPECT_TRUE(a.has_value() == b.has_value());
+
+	a = 42; b = 42;
+	EXPECT_TRUE(any_cast<int>(a) == any_cast<int>(b));
+	EXPECT_TRUE(a.has_value() == b.has_value());
+}
+
+TEST(AnyCastsTest, GivenEmptyAny_CastsReturnNullptr)
+{
+	any* a = nullptr;
+	EXPECT_TRUE(any_cast<int>(a) == nullptr);
+	EXPECT_TRUE(any_cast<short>(a) == nullptr);
+	EXPECT_TRUE(any_cast<long>(a) == nullptr);
+	EXPECT_TRUE(any_cast<std::string>(a) == nullptr);
+
+	any b;
+	EXPECT_TRUE(any_cast<short>(&b) == nullptr);
+	EXPECT_TRUE(any_cast<const short>(&b) == nullptr);
+	EXPECT_TRUE(any_cast<volatile short>(&b) == nullptr);
+	EXPECT_TRUE(any_cast<const volatile short>(&b) == nullptr);
+
+	EXPECT_TRUE(any_cast<short*>(&b) == nullptr);
+	EXPECT_TRUE(any_cast<const short*>(&b) == nullptr);
+	EXPECT_TRUE(any_cast<volatile short*>(&b) == nullptr);
+	EXPECT_TRUE(any_cast<const volatile short*>(&b) == nullptr);
+}
+
+TEST(EmplaceTests, GivenEmptyAny_EmplacingSmallObjectsWorks)
+{
+	any a;
+
+	a.emplace<int>(42);
+	EXPECT_TRUE(a.has_value());
+	EXPECT_EQ(any_cast<int>(a), 42);
+
+	a.emplace<short>((short)8); // no way to define a short literal we must cast here.
+	EXPECT_EQ(any_cast<short>(a), 8);
+	EXPECT_TRUE(a.has_value());
+
+	a.reset();
+	EXPECT_FALSE(a.has_value());
+}
+
+TEST(EmplaceTests, GivenEmptyAny_EmplacingLargeObjects_Works)
+{
+	TestObject::Reset();
+	{
+		any a;
+		a.emplace<TestObject>();
+		EXPECT_TRUE(a.has_value());
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(EmplaceTests, GivenEmptyAny_EmplaceInitializingThroughInitializerList_Works)
+{
+	{
+		any a;
+		a.emplace<RequiresInitList>(std::initializer_list<int>{1, 2, 3, 4, 5, 6});
+
+		EXPECT_TRUE(a.has_value());
+		EXPECT_EQ(any_cast<RequiresInitList>(a).sum, 21);
+	}
+}
+
+TEST(SwapTests, GivenNonEmptyAny_AnySwapWorks)
+{
+	any a1 = 42;
+	any a2 = 24;
+	EXPECT_EQ(any_cast<int>(a1), 42);
+	EXPECT_EQ(any_cast<int>(a2), 24);
+
+	a1.swap(a2);
+	EXPECT_EQ(any_cast<int>(a1), 24);
+	EXPECT_EQ(any_cast<int>(a2), 42);
+}
+
+TEST(SwapTests, GivenNonEmptyAny_STDSwapWorksOnAny)
+{
+	any a1 = 42;
+	any a2 = 24;
+
+	EXPECT_EQ(any_cast<int>(a1), 42);
+	EXPECT_EQ(any_cast<int>(a2), 24);
+
+	std::swap(a1, a2);
+
+	EXPECT_EQ(any_cast<int>(a1), 24);
+	EXPECT_EQ(any_cast<int>(a2), 42);
+}
+
+TEST(SwapTests, GivenNonEmptyListAny_SwapWorksAsExpected)
+{
 	any a1 = std::list<int>{1, 2, 3};
 	any a2 = std::list<int>{4, 5, 6};
 
@@ -412,58 +486,667 @@ TEST(SwapTests, GivenNonEmptyListAny_SwapWorksAsExpected)
 	std::list<int> result = any_cast<const std::list<int>&>(a1);
 
 	EXPECT_TRUE((result == std::list<int>{4, 5, 6}));
-}
-
-TEST(SwapTests, GivenNonEmptyStringAny_SwapWorksAsExpected)
-{
-	any a1 = std::string("firstString");
-	any a2 = std::string("secondString");
-
-	a1.swap(a2);
-
-	std::string result = any_cast<const std::string&>(a1);
-
-	EXPECT_EQ(result, std::string("secondString"));
-}
-
-TEST(SwapTests, GivenNonEmptyTOList_SwapWorksAsExpected)
-{
-	any a1 = std::list<TestObject>{TestObject(1), TestObject(2), TestObject(3), TestObject(4), TestObject(5)};
-	any a2 = std::list<TestObject>{TestObject(6), TestObject(7), TestObject(8), TestObject(9), TestObject(10)};
-
-	a1.swap(a2);
-
-	auto result = any_cast<const std::list<TestObject>&>(a1);
-
-	EXPECT_TRUE((result == std::list<TestObject>{TestObject(6), TestObject(7), TestObject(8), TestObject(9), TestObject(10)}));
-}
-
-TEST(TypeInfoTests, GivenNonEmptyAnys_TypeInfoIsCorrect)
-{
-	EXPECT_EQ(std::strcmp(any(42).type().name(), "int"), 0);
-	EXPECT_EQ(std::strcmp(any(42.f).type().name(), "float"), 0);
-	EXPECT_EQ(std::strcmp(any(42u).type().name(), "unsigned int"), 0);
-	EXPECT_EQ(std::strcmp(any(42ul).type().name(), "unsigned long"), 0);
-	EXPECT_EQ(std::strcmp(any(42l).type().name(), "long"), 0);
-}
-
-TEST(OperatorEQTests, GivenNonEmptyAny_MovingIntoAnyWorks)
-{
-	any a = std::string("hello world");
-	EXPECT_EQ(any_cast<std::string&>(a), "hello world");
-
-	auto s = std::move(any_cast<std::string&>(a)); // move string out
-	EXPECT_EQ(s, "hello world");
-	EXPECT_TRUE(any_cast<std::string&>(a).empty());
-
-	any_cast<std::string&>(a) = move(s); // move string in
-	EXPECT_EQ(any_cast<std::string&>(a), "hello world");
-}
-
-TEST(MakeAnyTests, GivenAuto_MakeAnyWorks)
-{
-	{
-		auto a = make_any<int>(42);
-		EXPECT_EQ(any_cast<int>(a), 42);
-	}
-}
\ No newline at end of file
+}
+
+TEST(SwapTests, GivenNonEmptyStringAny_SwapWorksAsExpected)
+{
+	any a1 = std::string("firstString");
+	any a2 = std::string("secondString");
+
+	a1.swap(a2);
+
+	std::string result = any_cast<const std::string&>(a1);
+
+	EXPECT_EQ(result, std::string("secondString"));
+}
+
+TEST(SwapTests, GivenNonEmptyTOList_SwapWorksAsExpected)
+{
+	any a1 = std::list<TestObject>{TestObject(1), TestObject(2), TestObject(3), TestObject(4), TestObject(5)};
+	any a2 = std::list<TestObject>{TestObject(6), TestObject(7), TestObject(8), TestObject(9), TestObject(10)};
+
+	a1.swap(a2);
+
+	auto result = any_cast<const std::list<TestObject>&>(a1);
+
+	EXPECT_TRUE((result == std::list<TestObject>{TestObject(6), TestObject(7), TestObject(8), TestObject(9), TestObject(10)}));
+}
+
+#if ANY_HAS_RTTI
+TEST(TypeInfoTests, GivenNonEmptyAnys_TypeInfoIsCorrect)
+{
+	// the names are implementation defined, compare against typeid instead
+	EXPECT_EQ(any(42).type(), typeid(int));
+	EXPECT_EQ(any(42.f).type(), typeid(float));
+	EXPECT_EQ(any(42u).type(), typeid(unsigned int));
+	EXPECT_EQ(any(42ul).type(), typeid(unsigned long));
+	EXPECT_EQ(any(42l).type(), typeid(long));
+	EXPECT_EQ(any().type(), typeid(void));
+}
+#endif
+
+TEST(TypeInfoTests, GivenNonEmptyAnys_TypeIdIsCorrect)
+{
+	EXPECT_EQ(any().type_id(), any_type_id_of<void>());
+	EXPECT_EQ(any(42).type_id(), any_type_id_of<int>());
+	EXPECT_EQ(any(42.f).type_id(), any_type_id_of<float>());
+	EXPECT_EQ(any(TestObject()).type_id(), any_type_id_of<TestObject>());
+	EXPECT_EQ(any(42).type_id(), any_type_id_of<const int>());
+
+	EXPECT_NE(any(42).type_id(), any_type_id_of<unsigned>());
+	EXPECT_NE(any(42l).type_id(), any_type_id_of<long long>());
+}
+
+TEST(OperatorEQTests, GivenNonEmptyAny_MovingIntoAnyWorks)
+{
+	any a = std::string("hello world");
+	EXPECT_EQ(any_cast<std::string&>(a), "hello world");
+
+	auto s = std::move(any_cast<std::string&>(a)); // move string out
+	EXPECT_EQ(s, "hello world");
+	EXPECT_TRUE(any_cast<std::string&>(a).empty());
+
+	any_cast<std::string&>(a) = move(s); // move string in
+	EXPECT_EQ(any_cast<std::string&>(a), "hello world");
+}
+
+TEST(MakeAnyTests, GivenAuto_MakeAnyWorks)
+{
+	{
+		auto a = make_any<int>(42);
+		EXPECT_EQ(any_cast<int>(a), 42);
+	}
+}
+TEST(BasicAnyTests, GivenCustomCapacities_SizeFollowsTheCapacity)
+{
+	EXPECT_LT(sizeof(basic_any<16, 8>), sizeof(any));
+	EXPECT_GT(sizeof(basic_any<128, 8>), sizeof(any));
+}
+
+TEST(BasicAnyTests, GivenSmallCapacity_LargerObjectsGoOnTheHeap)
+{
+	TestObject::Reset();
+	{
+		basic_any<16, 8> a = TestObject(42);
+		EXPECT_EQ(any_cast<TestObject&>(a).mX, 42);
+
+		basic_any<16, 8> b = a;
+		EXPECT_EQ(any_cast<TestObject&>(b).mX, 42);
+		EXPECT_NE(any_cast<TestObject>(&a), any_cast<TestObject>(&b));
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(BasicAnyTests, GivenBigValueInSmallCapacity_MovingToLargerCapacityStoresItInline)
+{
+	using Payload = std::array<int, 10>;
+
+	basic_any<16, 8> a = Payload{ 1, 2, 3 };
+	basic_any<128, 8> b = std::move(a);
+
+	EXPECT_FALSE(a.has_value());
+	EXPECT_EQ(any_cast<Payload&>(b)[2], 3);
+
+	auto bytes = reinterpret_cast<const char*>(any_cast<Payload>(&b));
+	EXPECT_TRUE(bytes >= reinterpret_cast<const char*>(&b) && bytes < reinterpret_cast<const char*>(&b + 1));
+}
+
+TEST(BasicAnyTests, GivenHeapValue_MovingToSmallerCapacityStealsTheBlock)
+{
+	TestObject::Reset();
+	{
+		basic_any<16, 8> a = TestObject(42);
+		const TestObject* object = any_cast<TestObject>(&a);
+
+		basic_any<24, 8> b = std::move(a);
+
+		EXPECT_FALSE(a.has_value());
+		EXPECT_EQ(any_cast<TestObject>(&b), object);
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(BasicAnyTests, GivenInlineValue_ConvertingToSmallerCapacitySpillsToTheHeap)
+{
+	using Payload = std::array<int, 10>;
+
+	basic_any<128, 8> a = Payload{ 1, 2, 3 };
+	basic_any<16, 8> b = a;
+	basic_any<16, 8> c = std::move(a);
+
+	EXPECT_EQ(any_cast<Payload&>(b)[2], 3);
+	EXPECT_EQ(any_cast<Payload&>(c)[2], 3);
+
+	any d = c;
+	EXPECT_EQ(any_cast<Payload&>(d)[2], 3);
+}
+
+// Counts the outstanding allocations so the tests can tell which resource a value lives in.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+	int mAllocations = 0;
+	int mLive = 0;
+
+private:
+	void* do_allocate(size_t bytes, size_t alignment) override
+	{
+		++mAllocations;
+		++mLive;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override
+	{
+		--mLive;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+};
+
+TEST(AllocatorTests, GivenMemoryResource_BigValuesAreAllocatedFromIt)
+{
+	CountingResource resource;
+	TestObject::Reset();
+	{
+		pmr::any a(std::allocator_arg, &resource, TestObject(42));
+		EXPECT_EQ(resource.mLive, 1);
+		EXPECT_EQ(a.get_allocator().resource(), &resource);
+
+		a = 42; // small values stay inline
+		EXPECT_EQ(resource.mLive, 0);
+
+		a.emplace<TestObject>(1337);
+		EXPECT_EQ(resource.mLive, 1);
+		EXPECT_EQ(any_cast<TestObject&>(a).mX, 1337);
+	}
+	EXPECT_EQ(resource.mLive, 0);
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(AllocatorTests, GivenMonotonicResource_BigValuesAreAllocatedFromTheArena)
+{
+	alignas(std::max_align_t) char buffer[1024];
+	std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+	TestObject::Reset();
+	{
+		pmr::any a(std::allocator_arg, &arena, TestObject(1));
+		pmr::any b = a;
+
+		for (const pmr::any* p : { &a, &b })
+		{
+			auto object = reinterpret_cast<const char*>(any_cast<TestObject>(p));
+			EXPECT_TRUE(object >= buffer && object < buffer + sizeof(buffer));
+		}
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+	arena.release();
+}
+
+TEST(AllocatorTests, GivenMemoryResource_CopyAndMovePropagateIt)
+{
+	CountingResource resource;
+	TestObject::Reset();
+	{
+		pmr::any a(std::allocator_arg, &resource, TestObject(42));
+
+		pmr::any b = a;
+		EXPECT_EQ(b.get_allocator().resource(), &resource);
+		EXPECT_EQ(resource.mLive, 2);
+
+		pmr::any c = std::move(a);
+		EXPECT_EQ(c.get_allocator().resource(), &resource);
+		EXPECT_EQ(resource.mAllocations, 2); // the block was stolen
+		EXPECT_EQ(any_cast<TestObject&>(c).mX, 42);
+	}
+	EXPECT_EQ(resource.mLive, 0);
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(AllocatorTests, GivenDifferentResources_AssignmentKeepsTheTargetResource)
+{
+	CountingResource first, second;
+	TestObject::Reset();
+	{
+		pmr::any a(std::allocator_arg, &first, TestObject(1));
+		pmr::any b(std::allocator_arg, &second);
+
+		b = a;
+		EXPECT_EQ(b.get_allocator().resource(), &second);
+		EXPECT_EQ(first.mLive, 1);
+		EXPECT_EQ(second.mLive, 1);
+
+		b = std::move(a);
+		EXPECT_EQ(b.get_allocator().resource(), &second);
+		EXPECT_EQ(first.mLive, 0);
+		EXPECT_EQ(second.mLive, 1);
+		EXPECT_EQ(any_cast<TestObject&>(b).mX, 1);
+	}
+	EXPECT_EQ(first.mLive, 0);
+	EXPECT_EQ(second.mLive, 0);
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(AllocatorTests, GivenDifferentResources_SwapExchangesTheResources)
+{
+	CountingResource first, second;
+	TestObject::Reset();
+	{
+		pmr::any a(std::allocator_arg, &first, TestObject(1));
+		pmr::any b(std::allocator_arg, &second, TestObject(2));
+
+		a.swap(b);
+		EXPECT_EQ(a.get_allocator().resource(), &second);
+		EXPECT_EQ(b.get_allocator().resource(), &first);
+		EXPECT_EQ(any_cast<TestObject&>(a).mX, 2);
+		EXPECT_EQ(any_cast<TestObject&>(b).mX, 1);
+		EXPECT_EQ(first.mAllocations + second.mAllocations, 2);
+	}
+	EXPECT_EQ(first.mLive, 0);
+	EXPECT_EQ(second.mLive, 0);
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(ReassignTests, GivenSameType_AssignmentAssignsInPlace)
+{
+	CountingResource resource;
+	TestObject::Reset();
+	{
+		pmr::any a(std::allocator_arg, &resource, TestObject(1));
+		const TestObject* object = any_cast<TestObject>(&a);
+
+		TestObject value(2);
+		a = value;
+		a = TestObject(3);
+		EXPECT_EQ(any_cast<TestObject>(&a), object);
+		EXPECT_EQ(any_cast<TestObject&>(a).mX, 3);
+		EXPECT_EQ(TestObject::sTOCopyAssignCount, 1);
+		EXPECT_EQ(TestObject::sTOMoveAssignCount, 1);
+		EXPECT_EQ(resource.mAllocations, 1);
+
+		a.emplace<TestObject>(TestObject(4));
+		EXPECT_EQ(any_cast<TestObject>(&a), object);
+		EXPECT_EQ(TestObject::sTOMoveAssignCount, 2);
+		EXPECT_EQ(resource.mAllocations, 1);
+
+		a.emplace<TestObject>(5, 0, 0); // constructed anew, in the same block
+		EXPECT_EQ(any_cast<TestObject>(&a), object);
+		EXPECT_EQ(any_cast<TestObject&>(a).mX, 5);
+		EXPECT_EQ(TestObject::sTOArgCtorCount, 1);
+		EXPECT_EQ(resource.mAllocations, 1);
+		EXPECT_EQ(resource.mLive, 1);
+	}
+	EXPECT_EQ(resource.mLive, 0);
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(ReassignTests, GivenSameType_StringKeepsItsCapacity)
+{
+	any a = std::string(100, 'x');
+	const char* data = any_cast<std::string&>(a).data();
+
+	const std::string shorter(50, 'y');
+	a = shorter;
+	EXPECT_EQ(any_cast<std::string&>(a), shorter);
+	EXPECT_EQ(any_cast<std::string&>(a).data(), data);
+}
+
+TEST(ReassignTests, GivenBigValueOfTheSamePoolSizeClass_EmplaceReusesTheBlock)
+{
+	using Small = std::array<char, 72>;
+	using Large = std::array<char, 80>;
+	static_assert(any_pool_allocator::interchangeable(sizeof(Small), alignof(Small), sizeof(Large), alignof(Large)));
+	static_assert(!any_pool_allocator::interchangeable(sizeof(Small), alignof(Small), 512, 8));
+
+	any a = Small{};
+	const void* block = any_cast<Small>(&a);
+	const size_t cached = any_pool_allocator::cached_blocks(sizeof(Large));
+
+	a.emplace<Large>();
+	EXPECT_EQ(static_cast<const void*>(any_cast<Large>(&a)), block);
+	EXPECT_EQ(any_pool_allocator::cached_blocks(sizeof(Large)), cached);
+}
+
+TEST(ReassignTests, GivenMemoryResource_OnlyBlocksOfTheSameSizeAreReused)
+{
+	CountingResource resource;
+	{
+		pmr::any a(std::allocator_arg, &resource, std::array<char, 72>{});
+		a.emplace<std::array<char, 80>>();
+		EXPECT_EQ(resource.mAllocations, 2);
+
+		a.emplace<std::array<unsigned char, 80>>();
+		EXPECT_EQ(resource.mAllocations, 2);
+		EXPECT_EQ(resource.mLive, 1);
+	}
+	EXPECT_EQ(resource.mLive, 0);
+}
+
+TEST(ReassignTests, GivenThrowingConstructor_EmplaceOverABigValueLeavesTheAnyEmpty)
+{
+	struct Thrower
+	{
+		explicit Thrower(int) { throw 42; }
+		char mPadding[100];
+	};
+
+	CountingResource resource;
+	{
+		pmr::any a(std::allocator_arg, &resource, std::array<char, sizeof(Thrower)>{});
+
+		EXPECT_THROW(a.emplace<Thrower>(1), int); // in the reused block
+		EXPECT_FALSE(a.has_value());
+		EXPECT_EQ(resource.mLive, 0);
+	}
+	EXPECT_EQ(resource.mAllocations, 1);
+}
+
+TEST(LayoutTests, GivenDefaultAny_ItIsTheBufferPlusTheHandlerPointer)
+{
+	EXPECT_EQ(sizeof(any), small_space_size + sizeof(void*));
+	EXPECT_EQ(sizeof(basic_any<16, 8>), 16 + sizeof(void*));
+}
+
+TEST(LayoutTests, GivenCacheLineAny_EveryElementOfAnArrayIsOneCacheLine)
+{
+	static_assert(sizeof(cache_line_any) == 64 && alignof(cache_line_any) == 64);
+
+	std::vector<cache_line_any> values(3, cache_line_any(std::array<char, 64 - sizeof(void*)>{}));
+	for (const cache_line_any& value : values)
+	{
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(&value) % 64, 0u);
+
+		// the largest small value fills the rest of the line
+		const uintptr_t object = reinterpret_cast<uintptr_t>(any_cast<std::array<char, 64 - sizeof(void*)>>(&value));
+		EXPECT_EQ(object, reinterpret_cast<uintptr_t>(&value));
+	}
+
+	cache_line_any big = std::array<char, 64>{};
+	const uintptr_t object = reinterpret_cast<uintptr_t>(any_cast<std::array<char, 64>>(&big));
+	EXPECT_TRUE(object < reinterpret_cast<uintptr_t>(&big) || object >= reinterpret_cast<uintptr_t>(&big + 1));
+}
+
+TEST(LayoutTests, GivenHandlerTables_TheyAreConstantsThatKnowTheRepresentation)
+{
+	constexpr const any_handler* small = &any_handlers<int, any_pool_allocator>::small;
+	constexpr const any_handler* big = &any_handlers<TestObject, any_pool_allocator>::big;
+
+	static_assert(small->_representation == any_representation::Small);
+	static_assert(big->_representation == any_representation::Big);
+	static_assert(small->_size == sizeof(int));
+	static_assert(big->_small == nullptr); // TestObject's move can throw, it's never inline
+
+	EXPECT_EQ(small->_id, any_type_id_of<int>());
+}
+
+struct NotComparable
+{
+	int mX = 0;
+};
+
+TEST(HashTests, GivenHashableTypes_HashIsTheOneOfTheValue)
+{
+	static_assert(any_handlers<int, any_pool_allocator>::small._hash == &any_compare::Hash<int>);
+	static_assert(any_handlers<NotComparable, any_pool_allocator>::small._hash == nullptr);
+	static_assert(any_handlers<NotComparable, any_pool_allocator>::small._equal == nullptr);
+
+	EXPECT_EQ(std::hash<any>{}(any(42)), std::hash<int>{}(42));
+	EXPECT_EQ(std::hash<any>{}(any(std::string("key"))), std::hash<std::string>{}("key"));
+	EXPECT_EQ(std::hash<any>{}(any(TestObject(7))), 7u); // big, through the block
+	EXPECT_EQ(std::hash<any>{}(any()), 0u);
+
+	EXPECT_THROW(any(NotComparable{}).hash(), bad_any_operation);
+}
+
+TEST(HashTests, GivenValues_EqualityComparesTypeThenValue)
+{
+	EXPECT_EQ(any(42), any(42));
+	EXPECT_NE(any(42), any(43));
+	EXPECT_NE(any(42), any(42L));
+	EXPECT_NE(any(42), any());
+	EXPECT_EQ(any(), any());
+	EXPECT_EQ(any(TestObject(1)), any(TestObject(1)));
+	using Small = basic_any<16, 8>; // the strings are big there
+	EXPECT_EQ(Small(std::string(100, 'x')), Small(std::string(100, 'x')));
+
+	EXPECT_THROW((void)(any(NotComparable{}) == any(NotComparable{})), bad_any_operation);
+	EXPECT_FALSE(any(NotComparable{}) == any(42)); // different types never get that far
+}
+
+TEST(HashTests, GivenContainersOfNonComparableTypes_TheyAreStoredWithoutEquality)
+{
+	// both declare an operator== that doesn't compile for NotComparable, the tables must not instantiate it
+	static_assert(!any_is_equality_comparable<std::vector<NotComparable>>::value);
+	static_assert(!any_is_equality_comparable<std::map<int, NotComparable>>::value);
+	static_assert(any_is_equality_comparable<std::vector<std::string>>::value);
+	static_assert(any_is_equality_comparable<std::map<int, std::string>>::value);
+
+	using Map = std::map<int, NotComparable>;
+
+	any values = std::vector<NotComparable>(3);
+	any map = Map{ { 1, NotComparable{} } };
+
+	EXPECT_EQ(any_cast<std::vector<NotComparable>&>(values).size(), 3u);
+	EXPECT_EQ(any_cast<Map&>(map).size(), 1u);
+	EXPECT_THROW((void)(values == any(values)), bad_any_operation);
+
+	EXPECT_EQ(any(std::vector<int>(2, 7)), any(std::vector<int>(2, 7)));
+	EXPECT_EQ(any(std::vector<Align16>(2)), any(std::vector<Align16>(2)));
+}
+
+TEST(HashTests, GivenUserTypeWithOperatorEqual_AnysHoldingItCompareIt)
+{
+	static_assert(any_is_equality_comparable<Align16>::value);
+	static_assert(!any_is_equality_comparable<NotComparable>::value);
+	static_assert(!any_is_equality_comparable<std::tuple<int, NotComparable>>::value);
+
+	EXPECT_EQ(any(Align16(3)), any(Align16(3)));
+	EXPECT_NE(any(Align16(3)), any(Align16(4)));
+}
+
+TEST(HashTests, GivenAnyKeys_UnorderedMapFindsThemByValue)
+{
+	TestObject::Reset();
+	{
+		std::unordered_map<any, int> cache;
+		cache[1] = 10;
+		cache[std::string("one")] = 20;
+		cache[TestObject(1)] = 30;
+		cache[1L] = 40;
+
+		EXPECT_EQ(cache.size(), 4u);
+		EXPECT_EQ(cache.at(1), 10);
+		EXPECT_EQ(cache.at(std::string("one")), 20);
+		EXPECT_EQ(cache.at(TestObject(1)), 30);
+		EXPECT_EQ(cache.at(1L), 40);
+		EXPECT_EQ(cache.count(2), 0u);
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+struct Print : any_operation<void(std::ostream&) const>
+{
+	template<class T>
+	static void apply(const T& self, std::ostream& out)
+	{
+		out << self;
+	}
+};
+
+struct Grow : any_operation<void(int)>
+{
+	template<class T>
+	static void apply(T& self, int by)
+	{
+		self += by;
+	}
+};
+
+struct SizeOf : any_operation<size_t() const>
+{
+	template<class T>
+	static size_t apply(const T&)
+	{
+		return sizeof(T);
+	}
+};
+
+struct Wide
+{
+	std::array<char, 100> mChars{};
+};
+
+std::ostream& operator<<(std::ostream& out, const Wide&)
+{
+	return out << "wide";
+}
+
+TEST(OperationTests, GivenUserOperations_TheyAreCalledThroughTheTable)
+{
+	using printable = any_with<Print, SizeOf>;
+	static_assert(sizeof(printable) == sizeof(any));
+	static_assert(any_handlers<int, any_pool_allocator, Print, SizeOf>::small.get<Print>() == &Print::erased<Print, int>);
+
+	std::vector<printable> values;
+	values.emplace_back(42);
+	values.emplace_back(std::string("text"));
+	values.emplace_back(Wide{}); // big
+
+	std::ostringstream out;
+	for (const printable& value : values)
+	{
+		value.call<Print>(out);
+		out << ' ';
+	}
+	EXPECT_EQ(out.str(), "42 text wide ");
+	EXPECT_EQ(values[2].call<SizeOf>(), sizeof(Wide));
+	EXPECT_EQ(any_cast<int>(values[0]), 42); // still an any
+}
+
+TEST(OperationTests, GivenNonConstOperation_ItModifiesTheValue)
+{
+	any_with<Grow> number = 1;
+	number.call<Grow>(41);
+	EXPECT_EQ(any_cast<int>(number), 42);
+
+	number = std::string("a");
+	number.call<Grow>('b');
+	EXPECT_EQ(any_cast<std::string&>(number), "ab");
+}
+
+TEST(OperationTests, GivenCopiesAndConversions_TheOperationsFollowTheValue)
+{
+	any_with<Print> wide = Wide{};
+	any_with<Print> copy = wide;
+	basic_any<128, 8, any_pool_allocator, false, Print> inline_wide = std::move(wide); // big to small
+
+	std::ostringstream out;
+	copy.call<Print>(out);
+	inline_wide.call<Print>(out);
+	EXPECT_EQ(out.str(), "widewide");
+
+	EXPECT_THROW(wide.call<Print>(out), bad_any_operation);
+}
+
+TEST(MoveTests, GivenMovedFromAny_ItHasNoValue)
+{
+	TestObject::Reset();
+	{
+		any a = 42;
+		any b = std::move(a);
+		EXPECT_FALSE(a.has_value());
+		EXPECT_EQ(any_cast<int>(b), 42);
+
+		any c = TestObject(42);
+		any d = std::move(c);
+		EXPECT_FALSE(c.has_value());
+		EXPECT_EQ(any_cast<TestObject&>(d).mX, 42);
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+// Points into itself, copying its bytes would leave <self> pointing at the source.
+struct SelfRef
+{
+	SelfRef() noexcept : self{ this } {}
+	SelfRef(const SelfRef&) noexcept : self{ this } {}
+	SelfRef& operator=(const SelfRef&) noexcept { return *this; }
+
+	bool IsValid() const noexcept { return self == this; }
+
+	SelfRef* self;
+};
+
+struct RelocatableCounter
+{
+	static inline int moves = 0;
+
+	RelocatableCounter(int x) noexcept : x{ x } {}
+	RelocatableCounter(const RelocatableCounter& other) noexcept : x{ other.x } {}
+	RelocatableCounter(RelocatableCounter&& other) noexcept : x{ other.x } { ++moves; }
+
+	int x;
+};
+
+template<>
+struct is_trivially_relocatable<RelocatableCounter> : std::true_type {};
+
+TEST(RelocationTests, GivenSelfReferentialValues_SwapAndMoveKeepThemValid)
+{
+	any a = SelfRef{};
+	any b = SelfRef{};
+	any c = 42;
+
+	swap(a, b);
+	EXPECT_TRUE(any_cast<SelfRef&>(a).IsValid());
+	EXPECT_TRUE(any_cast<SelfRef&>(b).IsValid());
+
+	swap(a, c);
+	EXPECT_TRUE(any_cast<SelfRef&>(c).IsValid());
+	EXPECT_EQ(any_cast<int>(a), 42);
+
+	any d = std::move(c);
+	EXPECT_TRUE(any_cast<SelfRef&>(d).IsValid());
+}
+
+TEST(RelocationTests, GivenRelocatableValue_MoveAndSwapCopyTheBytes)
+{
+	any a = RelocatableCounter{ 1 };
+	any b = RelocatableCounter{ 2 };
+	RelocatableCounter::moves = 0;
+
+	swap(a, b);
+	any c = std::move(a);
+
+	EXPECT_EQ(RelocatableCounter::moves, 0);
+	EXPECT_EQ(any_cast<RelocatableCounter&>(b).x, 1);
+	EXPECT_EQ(any_cast<RelocatableCounter&>(c).x, 2);
+}
+
+TEST(RelocationTests, GivenRelocatableAny_NonRelocatableValuesGoOnTheHeap)
+{
+	static_assert(is_trivially_relocatable_v<relocatable_any>);
+	static_assert(!is_trivially_relocatable_v<any>);
+	static_assert(relocatable_any::is_small<int>::value);
+	static_assert(!relocatable_any::is_small<SelfRef>::value);
+
+	std::vector<relocatable_any> values;
+	for (int i = 0; i < 100; ++i)
+	{
+		values.emplace_back(SelfRef{});
+	}
+
+	for (relocatable_any& value : values)
+	{
+		EXPECT_TRUE(any_cast<SelfRef&>(value).IsValid());
+	}
+
+	any inline_value = SelfRef{};
+	relocatable_any converted = std::move(inline_value);
+	EXPECT_TRUE(any_cast<SelfRef&>(converted).IsValid());
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "any_batch.h"
+#include <array>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct Tracked
+	{
+		explicit Tracked(int v) : value{ v } { ++live; }
+		Tracked(const Tracked& other) : value{ other.value } { ++live; }
+		Tracked(Tracked&& other) noexcept : value{ other.value } { ++live; }
+		~Tracked() { --live; }
+
+		static inline int live = 0;
+		int value;
+	};
+
+	using Big = std::array<char, small_space_size + 1>;
+
+	std::vector<any> Mixed()
+	{
+		std::vector<any> values;
+		for (int i = 0; i < 4; ++i)
+		{
+			values.emplace_back(i);
+		}
+		values.emplace_back();
+		values.emplace_back(std::string("text"));
+		values.emplace_back(std::in_place_type<Tracked>, 7);
+		values.emplace_back(std::in_place_type<Tracked>, 8);
+		values.emplace_back(Big{ 'b' });
+		values.emplace_back(4);
+		values.emplace_back(2.5);
+		return values;
+	}
+}
+
+TEST(AnyBatchTests, GivenMixedValues_ClearDestroysEveryOne)
+{
+	Tracked::live = 0;
+	std::vector<any> values = Mixed();
+	EXPECT_EQ(Tracked::live, 2);
+
+	any_reset(values.data() + 6, values.data() + 7);
+	EXPECT_EQ(Tracked::live, 1);
+	EXPECT_FALSE(values[6].has_value());
+	EXPECT_TRUE(values[7].has_value());
+
+	any_clear(values);
+	EXPECT_TRUE(values.empty());
+	EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(AnyBatchTests, GivenMixedValues_CopyMatchesTheElementwiseCopy)
+{
+	Tracked::live = 0;
+	{
+		const std::vector<any> values = Mixed();
+		const std::vector<any> copy = any_copy(values);
+
+		ASSERT_EQ(copy.size(), values.size());
+		for (size_t i = 0; i < values.size(); ++i)
+		{
+			EXPECT_EQ(copy[i].type_id(), values[i].type_id());
+		}
+		EXPECT_EQ(any_cast<int>(copy[2]), 2);
+		EXPECT_FALSE(copy[4].has_value());
+		EXPECT_EQ(any_cast<const std::string&>(copy[5]), "text");
+		EXPECT_EQ(any_cast<const Tracked&>(copy[7]).value, 8);
+		EXPECT_EQ(any_cast<const Big&>(copy[8])[0], 'b');
+		EXPECT_NE(any_cast<const Big>(&copy[8]), any_cast<const Big>(&values[8]));
+		EXPECT_EQ(any_cast<double>(copy[10]), 2.5);
+		EXPECT_EQ(Tracked::live, 4);
+
+		// the destination's old values are destroyed
+		std::vector<any> target(values.size(), any(std::in_place_type<Tracked>, 1));
+		EXPECT_EQ(Tracked::live, 4 + static_cast<int>(values.size()));
+		any_copy(values.data(), values.data() + values.size(), target.data());
+		EXPECT_EQ(Tracked::live, 6);
+		EXPECT_EQ(any_cast<int>(target[9]), 4);
+	}
+	EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(AnyBatchTests, GivenMixedValues_GatherCopiesOneTypeInOrder)
+{
+	const std::vector<any> values = Mixed();
+
+	std::vector<int> ints;
+	any_gather<int>(values, std::back_inserter(ints));
+	EXPECT_EQ(ints, (std::vector<int>{ 0, 1, 2, 3, 4 }));
+
+	std::array<std::string, 2> strings;
+	EXPECT_EQ(any_gather<std::string>(values, strings.data()), strings.data() + 1);
+	EXPECT_EQ(strings[0], "text");
+
+	std::vector<Big> bigs;
+	any_gather<Big>(values, std::back_inserter(bigs));
+	ASSERT_EQ(bigs.size(), 1u);
+	EXPECT_EQ(bigs[0][0], 'b');
+
+	std::vector<float> none;
+	any_gather<float>(values, std::back_inserter(none));
+	EXPECT_TRUE(none.empty());
+}
+
+TEST(AnyBatchTests, GivenStatefulAllocator_CopyKeepsTheAllocators)
+{
+	std::pmr::monotonic_buffer_resource resource;
+	std::vector<pmr::any> values;
+	values.emplace_back(std::allocator_arg, any_resource_allocator(&resource), 1);
+	values.emplace_back(std::allocator_arg, any_resource_allocator(&resource), Big{ 'p' });
+
+	std::vector<pmr::any> copy = any_copy(values);
+	EXPECT_EQ(any_cast<int>(copy[0]), 1);
+	EXPECT_TRUE(copy[1].get_allocator() == any_resource_allocator(&resource));
+
+	std::vector<pmr::any> target(2);
+	any_copy(values.data(), values.data() + 2, target.data());
+	EXPECT_EQ(any_cast<const Big&>(target[1])[0], 'p');
+	EXPECT_FALSE(target[1].get_allocator() == any_resource_allocator(&resource));
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "any_buffer.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct Tracked
+	{
+		static inline int live = 0;
+
+		explicit Tracked(int x = 0) : x{ x } { ++live; }
+		Tracked(const Tracked& other) : x{ other.x } { ++live; }
+		~Tracked() { --live; }
+
+		int x;
+	};
+
+	struct alignas(32) Aligned32
+	{
+		int x;
+	};
+}
+
+TEST(AnyBufferTests, GivenSmallValues_TheyArePackedWithTheirOwnSize)
+{
+	any_buffer buffer;
+
+	for (int i = 0; i < 100; ++i)
+	{
+		buffer.push_back(i);
+		buffer.push_back(std::array<char, 40>{});
+	}
+
+	EXPECT_EQ(buffer.size(), 200u);
+	// header + int padded to 8, header + 40 bytes
+	EXPECT_EQ(buffer.bytes_used(), 100 * (16 + 48));
+	EXPECT_LT(buffer.bytes_used(), 200 * sizeof(any));
+}
+
+TEST(AnyBufferTests, GivenMixedValues_IterationYieldsThemInOrder)
+{
+	any_buffer buffer;
+	buffer.push_back(1);
+	buffer.push_back(std::string("two"));
+	buffer.emplace_back<double>(3.0);
+	buffer.push_back(Aligned32{ 4 });
+
+	std::vector<any_type_id> types;
+	for (any_view value : buffer)
+	{
+		types.push_back(value.type_id());
+	}
+
+	EXPECT_EQ(types, (std::vector<any_type_id>{ any_type_id_of<int>(), any_type_id_of<std::string>(), any_type_id_of<double>(), any_type_id_of<Aligned32>() }));
+
+	auto it = buffer.begin();
+	EXPECT_EQ(any_cast<int>(*it++), 1);
+	EXPECT_EQ(any_cast<std::string&>(*it++), "two");
+	EXPECT_EQ(any_cast<double>(*it), 3.0);
+
+	any_view view = *it;
+	EXPECT_EQ(any_cast<int>(&view), nullptr);
+	EXPECT_THROW(any_cast<int>(view), bad_any_cast);
+
+	const_any_view aligned = *++it;
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned.object()) % 32, 0u);
+	EXPECT_EQ(any_cast<const Aligned32&>(aligned).x, 4);
+}
+
+TEST(AnyBufferTests, GivenManyValues_TheySpillIntoNewChunksWithoutMoving)
+{
+	any_buffer buffer;
+	std::vector<const void*> addresses;
+
+	for (int i = 0; i < 2000; ++i)
+	{
+		addresses.push_back(&buffer.push_back(std::array<int, 8>{ i }));
+	}
+	buffer.push_back(std::array<char, 10000>{}); // bigger than a chunk
+
+	int i = 0;
+	for (const_any_view value : std::as_const(buffer))
+	{
+		if (i < 2000)
+		{
+			EXPECT_EQ(value.object(), addresses[i]);
+			EXPECT_EQ((any_cast<const std::array<int, 8>&>(value)[0]), i);
+		}
+		++i;
+	}
+	EXPECT_EQ(i, 2001);
+}
+
+TEST(AnyBufferTests, GivenCopyAndClear_ValuesAreCopiedAndDestroyed)
+{
+	{
+		any_buffer buffer;
+		for (int i = 0; i < 10; ++i)
+		{
+			buffer.emplace_back<Tracked>(i);
+			buffer.push_back(i);
+		}
+
+		any_buffer trivial;
+		trivial.push_back(1);
+		trivial.push_back(2.0);
+
+		any_buffer copy = buffer;
+		any_buffer trivial_copy = trivial;
+		EXPECT_EQ(Tracked::live, 20);
+		EXPECT_EQ(copy.size(), 20u);
+		EXPECT_EQ(any_cast<double>(*++trivial_copy.begin()), 2.0);
+
+		int sum = 0;
+		for (any_view value : copy)
+		{
+			if (auto tracked = any_cast<Tracked>(&value))
+			{
+				sum += tracked->x;
+			}
+		}
+		EXPECT_EQ(sum, 45);
+
+		buffer.clear();
+		EXPECT_EQ(Tracked::live, 10);
+		EXPECT_TRUE(buffer.empty());
+		EXPECT_EQ(buffer.begin(), buffer.end());
+
+		buffer.push_back(Tracked{ 1 });
+		EXPECT_EQ(Tracked::live, 11);
+	}
+	EXPECT_EQ(Tracked::live, 0);
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "any_collection.h"
+#include <array>
+#include <numeric>
+#include <string>
+
+namespace
+{
+	struct Tracked
+	{
+		static inline int live = 0;
+		static inline int copies = 0;
+
+		explicit Tracked(int x = 0) : x{ x } { ++live; }
+		Tracked(const Tracked& other) : x{ other.x } { ++live; ++copies; }
+		Tracked(Tracked&& other) noexcept : x{ other.x } { ++live; }
+		~Tracked() { --live; }
+
+		int x;
+	};
+
+	// Its move can throw, so growing the segment has to copy
+	struct ThrowingMove
+	{
+		explicit ThrowingMove(int x = 0) : x{ x } {}
+		ThrowingMove(const ThrowingMove&) = default;
+		ThrowingMove(ThrowingMove&& other) noexcept(false) : x{ other.x } {}
+
+		int x;
+	};
+
+	using Big = std::array<int, 64>;
+}
+
+TEST(AnyCollectionTests, GivenMixedValues_TheyAreGroupedIntoContiguousSegments)
+{
+	any_collection c;
+
+	for (int i = 0; i < 100; ++i)
+	{
+		c.insert(i);
+		c.insert(std::to_string(i));
+		c.insert(static_cast<double>(i) / 2);
+	}
+
+	EXPECT_EQ(c.size(), 300u);
+	EXPECT_EQ(c.segment_count(), 3u);
+	EXPECT_EQ(c.size<int>(), 100u);
+	EXPECT_EQ(c.size<float>(), 0u);
+
+	auto ints = c.values<int>();
+	for (int i = 0; i < 100; ++i)
+	{
+		EXPECT_EQ(&ints[i], ints.begin() + i);
+		EXPECT_EQ(ints[i], i);
+	}
+
+	EXPECT_EQ(std::accumulate(ints.begin(), ints.end(), 0), 4950);
+	EXPECT_EQ(c.values<std::string>()[42], "42");
+	EXPECT_TRUE(c.values<float>().empty());
+}
+
+TEST(AnyCollectionTests, GivenBigValues_TheyAreStoredInTheSegmentItself)
+{
+	any_collection c;
+	Big& first = c.emplace<Big>();
+	first.fill(1);
+	c.emplace<Big>().fill(2);
+
+	auto bigs = c.values<Big>();
+	ASSERT_EQ(bigs.size(), 2u);
+	EXPECT_EQ(reinterpret_cast<char*>(&bigs[1]) - reinterpret_cast<char*>(&bigs[0]), static_cast<std::ptrdiff_t>(sizeof(Big)));
+	EXPECT_EQ(bigs[1][63], 2);
+}
+
+TEST(AnyCollectionTests, GivenForEach_EveryListedTypeIsVisited)
+{
+	any_collection c;
+	c.insert(1);
+	c.insert(2.5);
+	c.insert(3);
+	c.insert(std::string("skipped"));
+
+	double sum = 0;
+	c.for_each<int, double>([&](auto value) { sum += value; });
+
+	EXPECT_EQ(sum, 6.5);
+}
+
+TEST(AnyCollectionTests, GivenCopiesAndClear_ValuesAreCopiedAndDestroyedThroughTheHandlers)
+{
+	{
+		any_collection c;
+		for (int i = 0; i < 10; ++i)
+		{
+			c.emplace<Tracked>(i);
+		}
+		EXPECT_EQ(Tracked::copies, 0); // growth moves
+
+		any_collection copy = c;
+		EXPECT_EQ(Tracked::live, 20);
+		EXPECT_EQ(Tracked::copies, 10);
+		EXPECT_EQ(copy.values<Tracked>()[9].x, 9);
+
+		any_collection moved = std::move(c);
+		EXPECT_TRUE(c.empty());
+		EXPECT_EQ(Tracked::live, 20);
+
+		copy.clear();
+		EXPECT_EQ(Tracked::live, 10);
+	}
+	EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(AnyCollectionTests, GivenThrowingMove_GrowthCopiesTheValues)
+{
+	any_collection c;
+	for (int i = 0; i < 100; ++i)
+	{
+		c.emplace<ThrowingMove>(i);
+	}
+
+	auto values = c.values<ThrowingMove>();
+	for (int i = 0; i < 100; ++i)
+	{
+		EXPECT_EQ(values[i].x, i);
+	}
+}
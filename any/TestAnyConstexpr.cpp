@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "any.h"
+#include <array>
+
+// Built as C++20, see CMakeLists.txt. The checks are static_asserts, the tests only exist to show up in the results.
+#if ANY_HAS_CONSTEXPR
+
+namespace
+{
+	enum class Unit { Meter, Second };
+
+	// no padding, its bytes would be indeterminate in constant evaluation
+	struct Default
+	{
+		int id;
+		Unit unit;
+		double value;
+	};
+
+	constexpr any MakeDefault(int id)
+	{
+		return Default{ id, Unit::Second, id * 0.5 };
+	}
+
+	constinit const std::array<any, 4> defaults = { any(42), any(2.5f), MakeDefault(7), any() };
+
+	constexpr bool CopiesAndMoves()
+	{
+		any a = 3;
+		any b = a;
+		any c = std::move(a);
+		return !a.has_value() && any_cast<int>(b) == 3 && any_cast<int>(c) == 3;
+	}
+
+	constexpr bool ThrowsOnMismatch(const any& a)
+	{
+		return any_cast<float>(a) == 0; // a throw isn't a constant expression
+	}
+
+	template<class F, class = void>
+	struct IsConstant : std::false_type {};
+
+	template<class F>
+	struct IsConstant<F, std::void_t<std::integral_constant<bool, F{}()>>> : std::true_type {};
+}
+
+static_assert(any_cast<int>(any(5)) == 5);
+static_assert(any_cast<const long>(any(std::in_place_type<long>, 9L)) == 9L);
+static_assert(any(1).type_id() == any_type_id_of<int>());
+static_assert(!any().has_value());
+static_assert(CopiesAndMoves());
+static_assert(any_cast<Default>(MakeDefault(4)).unit == Unit::Second);
+static_assert(IsConstant<decltype([] { return any_cast<int>(any(1)) == 1; })>::value);
+static_assert(!IsConstant<decltype([] { return ThrowsOnMismatch(any(1)); })>::value);
+
+TEST(AnyConstexprTests, GivenConstinitTable_ValuesAreReadableAtRunTime)
+{
+	EXPECT_EQ(any_cast<int>(defaults[0]), 42);
+	EXPECT_EQ(any_cast<float>(defaults[1]), 2.5f);
+	EXPECT_EQ(any_cast<const Default&>(defaults[2]).id, 7);
+	EXPECT_EQ(any_cast<const Default&>(defaults[2]).value, 3.5);
+	EXPECT_FALSE(defaults[3].has_value());
+
+	any copy = defaults[2];
+	EXPECT_EQ(any_cast<Default>(copy).unit, Unit::Second);
+	EXPECT_EQ(any_cast<const float*>(&defaults[0]), nullptr);
+}
+
+TEST(AnyConstexprTests, GivenConstantEvaluatedAny_RunTimeCopiesBehaveTheSame)
+{
+	constexpr any constant = 11;
+	any copy = constant;
+	copy = 12;
+	EXPECT_EQ(any_cast<int>(constant), 11);
+	EXPECT_EQ(any_cast<int>(copy), 12);
+}
+
+#endif
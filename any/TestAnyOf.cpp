@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "any_of.h"
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct Tracked
+	{
+		explicit Tracked(int v) : value{ v } { ++live; }
+		Tracked(const Tracked& other) : value{ other.value } { ++live; }
+		Tracked(Tracked&& other) noexcept : value{ other.value } { ++live; }
+		Tracked& operator=(const Tracked&) = default;
+		~Tracked() { --live; }
+
+		static inline int live = 0;
+		int value;
+	};
+
+	using Value = any_of<int, double, std::string>;
+}
+
+static_assert(sizeof(any_of<char, short>) == 2 * sizeof(short));
+static_assert(sizeof(any_of<int, double>) == 2 * sizeof(double));
+static_assert(alignof(any_of<char, double>) == alignof(double));
+static_assert(std::is_same_v<any_of<int, float>::index_type, uint8_t>);
+static_assert(Value::index_of<std::string>() == 2 && Value::index_of<float>() == Value::npos);
+static_assert(!std::is_constructible_v<Value, float*>);
+
+TEST(AnyOfTests, GivenValue_TheAnyApiWorksOnIt)
+{
+	Value v = std::string("text");
+	EXPECT_TRUE(v.has_value());
+	EXPECT_EQ(v.index(), 2u);
+	EXPECT_EQ(v.type_id(), any_type_id_of<std::string>());
+#if ANY_HAS_RTTI
+	EXPECT_EQ(v.type(), typeid(std::string));
+#endif
+	EXPECT_EQ(any_cast<const std::string&>(v), "text");
+	EXPECT_EQ(any_cast<int>(&v), nullptr);
+	EXPECT_THROW(any_cast<double>(v), bad_any_cast);
+	EXPECT_EQ(*any_cast<const std::string>(&v), "text");
+	EXPECT_EQ(any_cast<const int>(&v), nullptr);
+	EXPECT_THROW(any_cast<const double>(v), bad_any_cast);
+
+	v.emplace<double>(2.5);
+	EXPECT_EQ(any_cast<double>(v), 2.5);
+
+	v.reset();
+	EXPECT_FALSE(v.has_value());
+	EXPECT_EQ(v.index(), Value::npos);
+	EXPECT_EQ(v.type_id(), any_type_id_of<void>());
+#if ANY_HAS_RTTI
+	EXPECT_EQ(v.type(), typeid(void));
+#endif
+}
+
+TEST(AnyOfTests, GivenCopyMoveAndSwap_ValuesAreConstructedAndDestroyedOnce)
+{
+	Tracked::live = 0;
+	{
+		any_of<int, Tracked> a(std::in_place_type<Tracked>, 4);
+		any_of<int, Tracked> b = a;
+		any_of<int, Tracked> c = std::move(a);
+		EXPECT_FALSE(a.has_value());
+		EXPECT_EQ(Tracked::live, 2);
+
+		a = 1;
+		swap(a, c);
+		EXPECT_EQ(any_cast<const Tracked&>(a).value, 4);
+		EXPECT_EQ(any_cast<int>(c), 1);
+
+		b = Tracked(9); // same alternative, assigned in place
+		EXPECT_EQ(any_cast<const Tracked&>(b).value, 9);
+		EXPECT_EQ(Tracked::live, 2);
+
+		std::vector<any_of<int, Tracked>> values(3, b);
+		values.emplace_back(5);
+		values.erase(values.begin());
+		EXPECT_EQ(Tracked::live, 4);
+	}
+	EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(AnyOfTests, GivenVisit_TheStoredAlternativeIsPassed)
+{
+	const auto describe = [](const auto& value) -> std::string
+	{
+		if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string>)
+		{
+			return "string " + value;
+		}
+		else
+		{
+			return std::to_string(value);
+		}
+	};
+
+	EXPECT_EQ(Value(3).visit(describe), "3");
+	EXPECT_EQ(Value(std::string("s")).visit(describe), "string s");
+
+	Value d = 1.0;
+	d.visit([](auto& value) { value += 1; });
+	EXPECT_EQ(any_cast<double>(d), 2.0);
+
+	EXPECT_THROW(Value{}.visit(describe), bad_any_cast);
+}
+
+TEST(AnyOfTests, GivenOpenAny_ItConvertsBothWays)
+{
+	Value v = std::string("moved");
+
+	any a = v.to_any();
+	EXPECT_EQ(any_cast<const std::string&>(a), "moved");
+	EXPECT_EQ(any_cast<const std::string&>(v), "moved");
+
+	any b = std::move(v).to_any();
+	EXPECT_EQ(any_cast<const std::string&>(b), "moved");
+	EXPECT_FALSE(Value{}.to_any().has_value());
+
+	Value back(a);
+	EXPECT_EQ(any_cast<const std::string&>(back), "moved");
+	EXPECT_EQ(any_cast<const std::string&>(a), "moved");
+
+	Value stolen(std::move(b));
+	EXPECT_EQ(any_cast<const std::string&>(stolen), "moved");
+
+	EXPECT_FALSE(Value(any{}).has_value());
+	EXPECT_THROW(Value(any(1.5f)), bad_any_cast);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "any.h"
+#include <array>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// 72 bytes, too big for the default inline buffer
+	using Payload72 = std::array<char, 72>;
+	using Payload500 = std::array<char, 500>;
+	using Payload4K = std::array<char, 4096>;
+}
+
+TEST(PoolTests, GivenBigValue_FreedBlockIsReusedByTheNextAllocation)
+{
+	any_pool_allocator::release_cached();
+
+	any a = Payload72{};
+	const void* first = any_cast<Payload72>(&a);
+	a.reset();
+	EXPECT_EQ(any_pool_allocator::cached_blocks(sizeof(Payload72)), 1u);
+
+	a = Payload72{ 'x' };
+	EXPECT_EQ(any_cast<Payload72>(&a), first);
+	EXPECT_EQ(any_pool_allocator::cached_blocks(sizeof(Payload72)), 0u);
+	EXPECT_EQ(any_cast<Payload72&>(a)[0], 'x');
+}
+
+TEST(PoolTests, GivenSizesInTheSameClass_BlocksAreShared)
+{
+	any_pool_allocator::release_cached();
+
+	any a = std::array<char, 70>{};
+	const void* first = any_cast<std::array<char, 70>>(&a);
+	a.reset();
+
+	a = Payload72{};
+	EXPECT_EQ(any_cast<Payload72>(&a), first);
+}
+
+TEST(PoolTests, GivenOversizedValue_ItBypassesThePool)
+{
+	any_pool_allocator::release_cached();
+
+	any a = Payload4K{};
+	a.reset();
+	EXPECT_EQ(any_pool_allocator::cached_blocks(sizeof(Payload4K)), 0u);
+}
+
+TEST(PoolTests, GivenManyFrees_TheCacheIsCapped)
+{
+	any_pool_allocator::release_cached();
+	{
+		std::vector<any> va(2 * any_pool_allocator::max_cached_bytes / 512, Payload500{});
+	}
+	EXPECT_EQ(any_pool_allocator::cached_blocks(sizeof(Payload500)), any_pool_allocator::max_cached_bytes / 512);
+	any_pool_allocator::release_cached();
+	EXPECT_EQ(any_pool_allocator::cached_blocks(sizeof(Payload500)), 0u);
+}
+
+TEST(PoolTests, GivenValuesAllocatedOnAnotherThread_TheyCanBeFreedHere)
+{
+	any_pool_allocator::release_cached();
+
+	std::vector<any> va;
+	std::thread producer([&va]
+	{
+		for (int i = 0; i < 100; ++i)
+		{
+			va.push_back(Payload72{ static_cast<char>(i) });
+		}
+	});
+	producer.join(); // the producer's cache is released when it exits, the values are still alive
+
+	for (int i = 0; i < 100; ++i)
+	{
+		EXPECT_EQ(any_cast<Payload72&>(va[i])[0], static_cast<char>(i));
+	}
+
+	va.clear();
+	EXPECT_EQ(any_pool_allocator::cached_blocks(sizeof(Payload72)), 100u);
+	any_pool_allocator::release_cached();
+}
+
+TEST(PoolTests, GivenManyThreads_ConstructingAndDestroyingBigValuesWorks)
+{
+	std::vector<std::thread> threads;
+
+	for (int t = 0; t < 8; ++t)
+	{
+		threads.emplace_back([t]
+		{
+			std::vector<any> va;
+			for (int i = 0; i < 1000; ++i)
+			{
+				if (i % 2)
+				{
+					va.push_back(Payload72{ static_cast<char>(t) });
+				}
+				else
+				{
+					va.push_back(Payload500{ static_cast<char>(t) });
+				}
+			}
+
+			for (auto& a : va)
+			{
+				const char* bytes = any_cast<Payload72>(&a) ? any_cast<Payload72&>(a).data() : any_cast<Payload500&>(a).data();
+				EXPECT_EQ(bytes[0], static_cast<char>(t));
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "any.h"
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+// Built as its own executable with ANY_ENABLE_STATS=1, the handler tables differ from the other tests.
+static_assert(ANY_ENABLE_STATS, "build this file with ANY_ENABLE_STATS=1");
+
+namespace
+{
+	struct SmallStat { int x; };
+	struct BigStat { std::array<char, 100> data; };
+
+	template<class T>
+	any_type_counts CountsOf()
+	{
+		std::vector<any_type_counts> counts = any_stats::snapshot();
+		auto it = std::find_if(counts.begin(), counts.end(), [](const any_type_counts& c) { return c.id == any_type_id_of<T>(); });
+
+		return it != counts.end() ? *it : any_type_counts{};
+	}
+}
+
+TEST(StatsTests, GivenSmallAndBigValues_EmplacesAndBytesAreCountedPerType)
+{
+	any_stats::reset();
+
+	any a = SmallStat{ 1 };
+	a.emplace<SmallStat>();
+	any b = BigStat{};
+
+	any_type_counts small = CountsOf<SmallStat>();
+	any_type_counts big = CountsOf<BigStat>();
+
+	EXPECT_EQ(small.small_emplaces, 2u);
+	EXPECT_EQ(small.big_emplaces, 0u);
+	EXPECT_EQ(small.bytes_allocated, 0u);
+	EXPECT_EQ(small.size, sizeof(SmallStat));
+
+	EXPECT_EQ(big.small_emplaces, 0u);
+	EXPECT_EQ(big.big_emplaces, 1u);
+	EXPECT_EQ(big.bytes_allocated, sizeof(BigStat));
+}
+
+TEST(StatsTests, GivenCopiesAndMoves_TheyAreCounted)
+{
+	any a = SmallStat{ 1 };
+	any b = BigStat{};
+	any_stats::reset();
+
+	any c = a;
+	any d = b;
+	any e = std::move(a);
+	any f = std::move(b);
+
+	EXPECT_EQ(CountsOf<SmallStat>().copies, 1u);
+	EXPECT_EQ(CountsOf<SmallStat>().moves, 1u);
+	EXPECT_EQ(CountsOf<BigStat>().copies, 1u);
+	EXPECT_EQ(CountsOf<BigStat>().moves, 1u);
+	EXPECT_EQ(CountsOf<BigStat>().bytes_allocated, sizeof(BigStat));
+}
+
+TEST(StatsTests, GivenWrongType_FailedCastsAreCountedForTheRequestedType)
+{
+	any a = SmallStat{ 1 };
+	any_stats::reset();
+
+	EXPECT_EQ(any_cast<BigStat>(&a), nullptr);
+	EXPECT_THROW(any_cast<const BigStat&>(a), bad_any_cast);
+	EXPECT_NE(any_cast<SmallStat>(&a), nullptr);
+
+	EXPECT_EQ(CountsOf<BigStat>().failed_casts, 2u);
+	EXPECT_EQ(CountsOf<SmallStat>().failed_casts, 0u);
+}
+
+TEST(StatsTests, GivenSmallCapacity_SpillsShowUpAsBigEmplaces)
+{
+	any_stats::reset();
+
+	basic_any<16, 8> small = std::string("spills");
+	any inline_string = std::string("fits");
+
+	EXPECT_EQ(CountsOf<std::string>().big_emplaces, 1u);
+	EXPECT_EQ(CountsOf<std::string>().small_emplaces, 1u);
+	EXPECT_EQ(CountsOf<std::string>().bytes_allocated, sizeof(std::string));
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "any_unchecked.h"
+#include "shared_any.h"
+#include "static_any.h"
+#include <array>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using Big = std::array<int, 32>;
+}
+
+TEST(AnyUncheckedTests, GivenKnownType_UncheckedCastReturnsTheValue)
+{
+	any small = 5;
+	any big = Big{ 1, 2, 3 };
+	const any text = std::string("text");
+
+	any_cast_unchecked<int>(small) = 6;
+	EXPECT_EQ(any_cast<int>(small), 6);
+	EXPECT_EQ(any_cast_unchecked<Big>(big)[2], 3);
+	EXPECT_EQ(any_cast_unchecked<std::string>(text), "text");
+
+	EXPECT_EQ(any_cast_unchecked<int>(&small), any_cast<int>(&small));
+	EXPECT_EQ(any_cast_unchecked<Big>(&big), any_cast<Big>(&big));
+	EXPECT_EQ(any_cast_unchecked<std::string>(&text), any_cast<std::string>(&text));
+
+	static_any s = 1.5;
+	EXPECT_EQ(any_cast_unchecked<double>(s), 1.5);
+}
+
+TEST(AnyUncheckedTests, GivenTypedRef_ItPointsAtTheValue)
+{
+	any big = Big{ 7 };
+	typed_any_ref<Big> ref(big);
+	EXPECT_EQ(ref.get(), any_cast<Big>(&big));
+
+	(*ref)[0] = 8;
+	EXPECT_EQ(any_cast<const Big&>(big)[0], 8);
+
+	typed_any_ref<const Big> view = ref;
+	EXPECT_EQ((*view)[0], 8);
+
+	const any number = 3;
+	typed_any_ref<const int> cref(number);
+	EXPECT_EQ(*cref, 3);
+}
+
+TEST(AnyUncheckedTests, GivenWrongType_TypedRefFails)
+{
+	any number = 3;
+	EXPECT_THROW(typed_any_ref<float>{ number }, bad_any_cast);
+
+	EXPECT_FALSE(typed_any_ref<float>(&number));
+	EXPECT_FALSE(typed_any_ref<int>(static_cast<any*>(nullptr)));
+	EXPECT_TRUE(typed_any_ref<int>(&number));
+
+	any empty;
+	EXPECT_FALSE(typed_any_ref<int>(&empty));
+}
+
+TEST(AnyUncheckedTests, GivenSharedAny_MutableAccessUnshares)
+{
+	// Big doesn't fit the buffer, so the copies share one block
+	shared_any a = Big{ 1, 2, 3 };
+	shared_any b = a;
+	EXPECT_EQ(a.use_count(), 2u);
+	EXPECT_EQ(b.use_count(), 2u);
+
+	typed_any_ref<Big> ref(b);
+	EXPECT_EQ(a.use_count(), 1u);
+	EXPECT_EQ(b.use_count(), 1u);
+
+	(*ref)[0] = 10;
+	any_cast_unchecked<Big>(a)[1] = 20;
+	EXPECT_EQ(any_cast<const Big&>(a)[0], 1);
+	EXPECT_EQ(any_cast<const Big&>(a)[1], 20);
+	EXPECT_EQ(any_cast<const Big&>(b)[0], 10);
+	EXPECT_EQ(any_cast<const Big&>(b)[1], 2);
+}
+
+TEST(AnyUncheckedTests, GivenSharedAny_OnlyTheMutableFormsCanThrow)
+{
+	static_assert(noexcept(any_cast_unchecked<Big>(std::declval<any&>())));
+	static_assert(noexcept(typed_any_ref<Big>(std::declval<any*>())));
+	static_assert(noexcept(any_cast_unchecked<Big>(std::declval<const shared_any&>())));
+	static_assert(noexcept(typed_any_ref<const Big>(std::declval<const shared_any*>())));
+	static_assert(!noexcept(any_cast_unchecked<Big>(std::declval<shared_any&>())));
+	static_assert(!noexcept(any_cast_unchecked<Big>(std::declval<shared_any*>())));
+	static_assert(!noexcept(typed_any_ref<Big>(std::declval<shared_any*>())));
+}
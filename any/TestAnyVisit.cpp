@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "any_visit.h"
+#include "unique_any.h"
+#include <array>
+#include <memory>
+#include <string>
+
+namespace
+{
+	template<int N>
+	struct Alt
+	{
+		int value = N;
+	};
+
+	struct Describe
+	{
+		std::string operator()(int i) const { return "int " + std::to_string(i); }
+		std::string operator()(const std::string& s) const { return "string " + s; }
+		std::string operator()(double) const { return "double"; }
+	};
+}
+
+TEST(AnyVisitTests, GivenAlternatives_TheMatchingOverloadIsCalled)
+{
+	any i = 42;
+	any s = std::string("text");
+	any d = 1.5;
+
+	EXPECT_EQ((any_visit<int, std::string, double>(Describe{}, i)), "int 42");
+	EXPECT_EQ((any_visit<int, std::string, double>(Describe{}, s)), "string text");
+	EXPECT_EQ((any_visit<int, std::string, double>(Describe{}, d)), "double");
+}
+
+TEST(AnyVisitTests, GivenTypeOutsideTheList_TheFallbackGetsTheAny)
+{
+	any f = 1.f;
+	any empty;
+
+	auto other = [](const any& a) { return a.has_value() ? std::string("other") : std::string("empty"); };
+
+	EXPECT_EQ((any_visit<int, std::string, double>(Describe{}, f, other)), "other");
+	EXPECT_EQ((any_visit<int, std::string, double>(Describe{}, empty, other)), "empty");
+	EXPECT_THROW((any_visit<int, std::string, double>(Describe{}, f)), bad_any_cast);
+}
+
+TEST(AnyVisitTests, GivenMutableAny_TheVisitorCanChangeTheValue)
+{
+	any big = std::array<int, 32>{};
+	any small = 1;
+
+	auto increment = [](auto& value)
+	{
+		if constexpr (std::is_same_v<std::decay_t<decltype(value)>, int>)
+		{
+			++value;
+		}
+		else
+		{
+			++value[0];
+		}
+	};
+
+	any_visit<int, std::array<int, 32>>(increment, big);
+	any_visit<int, std::array<int, 32>>(increment, small);
+
+	EXPECT_EQ((any_cast<std::array<int, 32>&>(big)[0]), 1);
+	EXPECT_EQ(any_cast<int>(small), 2);
+
+	const any& constant = small;
+	any_visit<int>([](auto& value) { static_assert(std::is_const_v<std::remove_reference_t<decltype(value)>>); }, constant);
+}
+
+TEST(AnyVisitTests, GivenManyAlternatives_EveryOneIsFound)
+{
+	using index = any_type_index<Alt<0>, Alt<1>, Alt<2>, Alt<3>, Alt<4>, Alt<5>, Alt<6>, Alt<7>, Alt<8>, Alt<9>,
+								 Alt<10>, Alt<11>, Alt<12>, Alt<13>, Alt<14>, Alt<15>, Alt<16>, Alt<17>, Alt<18>, Alt<19>>;
+
+	EXPECT_EQ(index::find(any_type_id_of<Alt<0>>()), 0u);
+	EXPECT_EQ(index::find(any_type_id_of<Alt<7>>()), 7u);
+	EXPECT_EQ(index::find(any_type_id_of<Alt<19>>()), 19u);
+	EXPECT_EQ(index::find(any_type_id_of<int>()), index::npos);
+
+	any a = Alt<13>{};
+	int visited = any_visit<Alt<0>, Alt<5>, Alt<13>, Alt<19>>([](auto& alt) { return alt.value; }, a);
+	EXPECT_EQ(visited, 13);
+}
+
+TEST(AnyVisitTests, GivenUniqueAny_ItCanBeVisited)
+{
+	unique_any a = std::make_unique<int>(7);
+
+	int value = any_visit<std::unique_ptr<int>>([](auto& p) { return *p; }, a);
+	EXPECT_EQ(value, 7);
+}
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include "atomic_any.h"
+#include <array>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// A big value that counts the live instances and can check it wasn't torn or freed under a reader
+	struct Config
+	{
+		explicit Config(int v = 0) : version{ v } { values.fill(v); ++live; }
+		Config(const Config& other) : version{ other.version }, values{ other.values } { ++live; }
+		Config& operator=(const Config&) = default;
+		~Config() { version = -1; --live; }
+
+		bool IsConsistent() const
+		{
+			for (int v : values)
+			{
+				if (v != version)
+				{
+					return false;
+				}
+			}
+			return version >= 0;
+		}
+
+		static inline std::atomic<int> live{ 0 };
+		int version;
+		std::array<int, 32> values;
+	};
+}
+
+TEST(AtomicAnyTests, GivenDefaultAtomicAny_LoadReturnsAnEmptySnapshot)
+{
+	atomic_any a;
+	atomic_any::snapshot s = a.load();
+
+	EXPECT_FALSE(s.has_value());
+	EXPECT_FALSE(s->has_value());
+	EXPECT_TRUE(a.is_lock_free());
+}
+
+TEST(AtomicAnyTests, GivenStoredValue_LoadSeesIt)
+{
+	atomic_any a(std::string("first"));
+	EXPECT_EQ(any_cast<const std::string&>(*a.load()), "first");
+
+	a.store(42);
+	EXPECT_EQ(any_cast<int>(*a.load()), 42);
+
+	a.store(any{});
+	EXPECT_FALSE(a.load().has_value());
+}
+
+TEST(AtomicAnyTests, GivenSnapshot_StoreDoesntChangeOrFreeIt)
+{
+	Config::live = 0;
+	{
+		atomic_any a(Config(1));
+		atomic_any::snapshot before = a.load();
+
+		a.store(Config(2));
+		any_hazard_pointers::collect();
+
+		EXPECT_EQ(any_cast<const Config&>(*before).version, 1);
+		EXPECT_EQ(any_cast<const Config&>(*a.load()).version, 2);
+		EXPECT_EQ(Config::live, 2);
+	}
+	any_hazard_pointers::collect();
+	EXPECT_EQ(Config::live, 0);
+}
+
+TEST(AtomicAnyTests, GivenExchange_ItReturnsThePreviousValue)
+{
+	atomic_any a(1);
+
+	atomic_any::snapshot previous = a.exchange(2);
+	EXPECT_EQ(any_cast<int>(*previous), 1);
+	EXPECT_EQ(any_cast<int>(*a.load()), 2);
+
+	EXPECT_FALSE(atomic_any{}.exchange(3).has_value());
+}
+
+TEST(AtomicAnyTests, GivenCompareExchange_ItOnlySucceedsAgainstTheCurrentValue)
+{
+	atomic_any a(1);
+	atomic_any::snapshot expected = a.load();
+	atomic_any::snapshot stale = a.load();
+
+	EXPECT_TRUE(a.compare_exchange(expected, 2));
+	EXPECT_EQ(any_cast<int>(*a.load()), 2);
+
+	// an equal value stored again is still a different store
+	a.store(2);
+	EXPECT_FALSE(a.compare_exchange(stale, 3));
+	EXPECT_EQ(any_cast<int>(*stale), 2);
+	EXPECT_EQ(any_cast<int>(*a.load()), 2);
+
+	EXPECT_TRUE(a.compare_exchange(stale, 3));
+	EXPECT_EQ(any_cast<int>(*a.load()), 3);
+}
+
+TEST(AtomicAnyTests, GivenDestroyedAtomicAny_SnapshotsKeepTheLastValue)
+{
+	Config::live = 0;
+	atomic_any::snapshot s;
+	{
+		atomic_any a(Config(7));
+		s = a.load();
+	}
+	any_hazard_pointers::collect();
+	EXPECT_EQ(any_cast<const Config&>(*s).version, 7);
+
+	s = {};
+	any_hazard_pointers::collect();
+	EXPECT_EQ(Config::live, 0);
+}
+
+TEST(AtomicAnyTests, GivenReadersAndWriters_ReadersAlwaysSeeAWholeValue)
+{
+	Config::live = 0;
+	{
+		atomic_any a(Config(0));
+		std::atomic<bool> done{ false };
+		std::atomic<int> torn{ 0 };
+
+		std::vector<std::thread> readers;
+		for (int i = 0; i < 4; ++i)
+		{
+			readers.emplace_back([&]
+			{
+				int last = 0;
+				while (!done.load(std::memory_order_relaxed))
+				{
+					atomic_any::snapshot s = a.load();
+					const Config& config = any_cast<const Config&>(*s);
+
+					if (!config.IsConsistent() || config.version < last)
+					{
+						++torn;
+					}
+					last = config.version;
+				}
+			});
+		}
+
+		for (int version = 1; version <= 2000; ++version)
+		{
+			a.store(Config(version));
+		}
+		done = true;
+
+		for (std::thread& reader : readers)
+		{
+			reader.join();
+		}
+		EXPECT_EQ(torn, 0);
+	}
+	any_hazard_pointers::collect();
+	EXPECT_EQ(Config::live, 0);
+}
+
+TEST(AtomicAnyTests, GivenConcurrentCompareExchangeLoops_NoUpdateIsLost)
+{
+	atomic_any counter(0);
+	constexpr int threads = 4;
+	constexpr int increments = 1000;
+
+	std::vector<std::thread> writers;
+	for (int i = 0; i < threads; ++i)
+	{
+		writers.emplace_back([&]
+		{
+			for (int n = 0; n < increments; ++n)
+			{
+				atomic_any::snapshot expected = counter.load();
+				while (!counter.compare_exchange(expected, any_cast<int>(*expected) + 1))
+				{
+				}
+			}
+		});
+	}
+
+	for (std::thread& writer : writers)
+	{
+		writer.join();
+	}
+	EXPECT_EQ(any_cast<int>(*counter.load()), threads * increments);
+}
+
+TEST(AtomicAnyTests, GivenConcurrentCompareExchangeToEmpty_TheLosersDropNothing)
+{
+	Config::live = 0;
+	{
+		atomic_any slot;
+		constexpr int threads = 4;
+		constexpr int rounds = 5000;
+		std::atomic<int> puts{ 0 };
+		std::atomic<int> takes{ 0 };
+
+		// half the threads fill the slot, the other half empty it, so most exchanges race against another one
+		std::vector<std::thread> workers;
+		for (int i = 0; i < threads; ++i)
+		{
+			workers.emplace_back([&, fill = i % 2 == 0]
+			{
+				for (int n = 0; n < rounds; ++n)
+				{
+					atomic_any::snapshot expected = slot.load();
+					if (expected.has_value() != fill && slot.compare_exchange(expected, fill ? any(Config(n)) : any{}))
+					{
+						++(fill ? puts : takes);
+					}
+				}
+			});
+		}
+
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+		EXPECT_EQ(puts - takes, slot.load().has_value() ? 1 : 0);
+	}
+	any_hazard_pointers::collect();
+	EXPECT_EQ(Config::live, 0);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include "any_unchecked.h"
+#include "compact_any.h"
+#include <array>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using Big = std::array<int, 32>;
+
+	struct Tracked
+	{
+		Tracked() { ++live; }
+		Tracked(const Tracked&) { ++live; }
+		~Tracked() { --live; }
+
+		static inline int live = 0;
+	};
+
+	struct alignas(32) OverAligned
+	{
+		int value;
+	};
+}
+
+static_assert(sizeof(compact_any) == sizeof(void*));
+static_assert(is_trivially_relocatable_v<compact_any>);
+static_assert(std::is_nothrow_move_constructible_v<compact_any>);
+
+TEST(CompactAnyTests, GivenBigValue_ItLivesInOneBlockAfterItsHeader)
+{
+	compact_any a = Big{ 1, 2, 3 };
+	EXPECT_TRUE(a.has_value());
+	EXPECT_EQ(a.type_id(), any_type_id_of<Big>());
+#if ANY_HAS_RTTI
+	EXPECT_EQ(a.type(), typeid(Big));
+#endif
+	EXPECT_EQ(any_cast<const Big&>(a)[2], 3);
+	EXPECT_EQ(any_cast<int>(&a), nullptr);
+	EXPECT_THROW(any_cast<std::string>(a), bad_any_cast);
+
+	void* block = nullptr;
+	std::memcpy(&block, &a, sizeof(block));
+	const compact_any_handler* table = &compact_any_handlers<Big, any_pool_allocator>::table;
+	EXPECT_EQ(*static_cast<const compact_any_handler**>(block), table);
+
+	compact_any aligned = OverAligned{ 5 };
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(any_cast<OverAligned>(&aligned)) % 32, 0u);
+	EXPECT_EQ(any_cast<OverAligned>(aligned).value, 5);
+}
+
+TEST(CompactAnyTests, GivenSmallScalar_ItIsTaggedInsideThePointer)
+{
+	if constexpr (sizeof(void*) >= 8)
+	{
+		compact_any i = -7;
+		compact_any f = 1.5f;
+		compact_any b = true;
+		compact_any c = 'x';
+
+		for (compact_any* a : { &i, &f, &b, &c })
+		{
+			uintptr_t bits = 0;
+			std::memcpy(&bits, a, sizeof(bits));
+			EXPECT_EQ(bits & 1, 1u);
+
+			const uintptr_t object = reinterpret_cast<uintptr_t>(a->get_val<char>());
+			EXPECT_GE(object, reinterpret_cast<uintptr_t>(a));
+			EXPECT_LT(object, reinterpret_cast<uintptr_t>(a + 1));
+		}
+
+		EXPECT_EQ(any_cast<int>(i), -7);
+		EXPECT_EQ(any_cast<float>(f), 1.5f);
+		EXPECT_TRUE(any_cast<bool>(b));
+		EXPECT_EQ(any_cast<char>(c), 'x');
+		EXPECT_EQ(f.type_id(), any_type_id_of<float>());
+#if ANY_HAS_RTTI
+		EXPECT_EQ(c.type(), typeid(char));
+#endif
+		EXPECT_EQ(any_cast<unsigned>(&i), nullptr);
+
+		i = 12; // in place
+		EXPECT_EQ(any_cast<int>(i), 12);
+	}
+
+	static_assert(!compact_any::is_inline<double>::value && !compact_any::is_inline<long long>::value);
+}
+
+TEST(CompactAnyTests, GivenCopyMoveAndSwap_BlocksAreCopiedOrHandedOver)
+{
+	Tracked::live = 0;
+	{
+		compact_any a(std::in_place_type<Tracked>);
+		compact_any b = a;
+		EXPECT_NE(any_cast<Tracked>(&a), any_cast<Tracked>(&b));
+
+		const Tracked* object = any_cast<Tracked>(&a);
+		compact_any c = std::move(a);
+		EXPECT_FALSE(a.has_value());
+		EXPECT_EQ(any_cast<Tracked>(&c), object);
+
+		compact_any d = 3;
+		swap(c, d);
+		EXPECT_EQ(any_cast<Tracked>(&d), object);
+		EXPECT_EQ(any_cast<int>(c), 3);
+
+		std::vector<compact_any> values;
+		for (int i = 0; i < 100; ++i)
+		{
+			values.emplace_back(std::string(40, 'a' + i % 26));
+			values.emplace_back(i);
+		}
+		EXPECT_EQ(any_cast<const std::string&>(values[198]), std::string(40, 'a' + 99 % 26));
+		EXPECT_EQ(any_cast<int>(values[199]), 99);
+	}
+	EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(CompactAnyTests, GivenThrowingEmplace_TheOldValueIsKept)
+{
+	struct Thrower
+	{
+		Thrower() { throw 1; }
+		Thrower(const Thrower&) = default;
+	};
+
+	compact_any a = std::string("kept");
+	EXPECT_THROW(a.emplace<Thrower>(), int);
+	EXPECT_EQ(any_cast<const std::string&>(a), "kept");
+
+	a.reset();
+	EXPECT_FALSE(a.has_value());
+	EXPECT_EQ(a.type_id(), any_type_id_of<void>());
+}
+
+TEST(CompactAnyTests, GivenConstQualifiedCast_TaggedAndBigValuesAreFound)
+{
+	const compact_any big = Big{ 1, 2, 3 };
+	EXPECT_EQ((*any_cast<const Big>(&big))[1], 2);
+	EXPECT_EQ(any_cast<const Big>(big)[2], 3);
+	EXPECT_EQ(any_cast_unchecked<const Big>(big)[0], 1);
+
+	compact_any tagged = 42;
+	EXPECT_EQ(any_cast<const int>(&tagged), any_cast<int>(&tagged));
+	EXPECT_EQ(*any_cast<const int>(&tagged), 42);
+	EXPECT_EQ(any_cast<const int>(tagged), 42);
+	EXPECT_EQ(any_cast_unchecked<const int>(tagged), 42);
+	EXPECT_EQ(any_cast<const float>(&tagged), nullptr);
+
+	static_assert(compact_any::is_inline<const int>::value == compact_any::is_inline<int>::value);
+}
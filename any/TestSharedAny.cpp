@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "shared_any.h"
+#include <array>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// A big value that counts its deep copies
+	struct Table
+	{
+		Table() = default;
+		Table(const Table& other) : values{ other.values } { ++copies; }
+
+		static inline int copies = 0;
+		std::array<int, 64> values{};
+	};
+}
+
+TEST(SharedAnyTests, GivenBigValue_CopiesShareTheBlock)
+{
+	shared_any a = Table{};
+	Table::copies = 0;
+
+	shared_any b = a;
+	shared_any c;
+	c = b;
+
+	EXPECT_EQ(Table::copies, 0);
+	EXPECT_EQ(a.use_count(), 3u);
+	EXPECT_EQ(any_cast<Table>(&std::as_const(a)), any_cast<Table>(&std::as_const(c)));
+
+	c.reset();
+	EXPECT_EQ(a.use_count(), 2u);
+}
+
+TEST(SharedAnyTests, GivenSharedValue_OnlyMutableAccessCopiesIt)
+{
+	shared_any a = Table{};
+	shared_any b = a;
+	Table::copies = 0;
+
+	EXPECT_EQ(any_cast<const Table&>(b).values[0], 0);
+	EXPECT_EQ(any_cast<Table>(b).values[0], 0); // copies into the result, doesn't unshare
+	EXPECT_EQ(Table::copies, 1);
+	EXPECT_EQ(b.use_count(), 2u);
+
+	any_cast<Table&>(b).values[0] = 42;
+	EXPECT_EQ(Table::copies, 2);
+	EXPECT_EQ(a.use_count(), 1u);
+	EXPECT_EQ(b.use_count(), 1u);
+	EXPECT_EQ(any_cast<const Table&>(a).values[0], 0);
+	EXPECT_EQ(any_cast<const Table&>(b).values[0], 42);
+
+	// b owns its copy now
+	any_cast<Table&>(b).values[1] = 7;
+	EXPECT_EQ(Table::copies, 2);
+}
+
+TEST(SharedAnyTests, GivenReferenceHandedOut_LaterCopiesDontShareTheBlock)
+{
+	shared_any a = Table{};
+	Table& table = any_cast<Table&>(a); // a isn't shared, so nothing is copied, but the reference outlives the cast
+	Table::copies = 0;
+
+	shared_any b = a;
+	EXPECT_EQ(Table::copies, 1);
+	EXPECT_EQ(a.use_count(), 1u);
+	EXPECT_EQ(b.use_count(), 1u);
+
+	table.values[0] = 42;
+	EXPECT_EQ(any_cast<const Table&>(a).values[0], 42);
+	EXPECT_EQ(any_cast<const Table&>(b).values[0], 0);
+
+	// b's block never handed out a reference, and a new value in a starts shareable again
+	shared_any c = b;
+	a = Table{};
+	shared_any d = a;
+	EXPECT_EQ(b.use_count(), 2u);
+	EXPECT_EQ(a.use_count(), 2u);
+}
+
+TEST(SharedAnyTests, GivenSmallValue_CopiesAreIndependent)
+{
+	shared_any a = std::string("small");
+	shared_any b = a;
+
+	any_cast<std::string&>(b) += "er";
+
+	EXPECT_EQ(a.use_count(), 1u);
+	EXPECT_EQ(any_cast<std::string&>(a), "small");
+	EXPECT_EQ(any_cast<std::string&>(b), "smaller");
+}
+
+TEST(SharedAnyTests, GivenDifferentResources_AssignmentCopiesIntoTheTargetResource)
+{
+	std::pmr::unsynchronized_pool_resource first, second;
+
+	pmr::shared_any a(std::allocator_arg, &first, Table{});
+	pmr::shared_any b(std::allocator_arg, &second);
+	pmr::shared_any c(std::allocator_arg, &first);
+
+	b = a;
+	c = a;
+
+	EXPECT_EQ(b.get_allocator().resource(), &second);
+	EXPECT_EQ(b.use_count(), 1u);
+	EXPECT_EQ(c.use_count(), 2u);
+
+	b = std::move(c);
+	EXPECT_EQ(b.get_allocator().resource(), &second);
+	EXPECT_FALSE(c.has_value());
+	EXPECT_EQ(a.use_count(), 1u);
+}
+
+TEST(SharedAnyTests, GivenCopiesOnManyThreads_TheValueIsFreedOnce)
+{
+	Table table;
+	table.values.fill(7);
+	shared_any snapshot = table;
+	std::vector<std::thread> threads;
+
+	for (int i = 0; i < 8; ++i)
+	{
+		threads.emplace_back([copy = snapshot, i]() mutable
+		{
+			for (int j = 0; j < 1000; ++j)
+			{
+				shared_any local = copy;
+				EXPECT_EQ(any_cast<const Table&>(local).values[j % 64], 7);
+			}
+
+			if (i % 2)
+			{
+				any_cast<Table&>(copy).values[0] = i;
+			}
+		});
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	EXPECT_EQ(snapshot.use_count(), 1u);
+	EXPECT_EQ(any_cast<const Table&>(snapshot).values[0], 7);
+}
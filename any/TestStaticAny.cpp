@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "static_any.h"
+#include <array>
+#include <string>
+
+namespace
+{
+	struct Tracked
+	{
+		explicit Tracked(int v) noexcept : value{ v } { ++live; }
+		Tracked(const Tracked& other) noexcept : value{ other.value } { ++live; }
+		Tracked(Tracked&& other) noexcept : value{ other.value } { other.value = -1; ++live; }
+		~Tracked() { --live; }
+
+		static inline int live = 0;
+		int value;
+	};
+
+	struct ThrowingCopy
+	{
+		ThrowingCopy() = default;
+		ThrowingCopy(const ThrowingCopy&) {}
+	};
+}
+
+static_assert(std::is_nothrow_copy_constructible_v<static_any>);
+static_assert(std::is_nothrow_move_constructible_v<static_any>);
+static_assert(std::is_nothrow_copy_assignable_v<static_any>);
+static_assert(std::is_nothrow_move_assignable_v<static_any>);
+static_assert(std::is_nothrow_constructible_v<static_any, int>);
+static_assert(noexcept(std::declval<static_any&>().emplace<int>(1)));
+static_assert(noexcept(std::declval<static_any&>().swap(std::declval<static_any&>())));
+static_assert(noexcept(any_cast<int>(std::declval<static_any*>())));
+
+static_assert(static_any::fits<int>::value);
+static_assert(!static_any::fits<std::array<char, small_space_size + 1>>::value);
+static_assert(!static_any::fits<ThrowingCopy>::value);
+static_assert(sizeof(basic_static_any<24, 8>) == 24 + sizeof(void*));
+
+TEST(StaticAnyTests, GivenValue_ItIsStoredInline)
+{
+	static_any a = 42;
+	EXPECT_TRUE(a.has_value());
+	EXPECT_EQ(a.type_id(), any_type_id_of<int>());
+	EXPECT_EQ(any_cast<int>(a), 42);
+
+	const uintptr_t object = reinterpret_cast<uintptr_t>(any_cast<int>(&a));
+	EXPECT_GE(object, reinterpret_cast<uintptr_t>(&a));
+	EXPECT_LT(object, reinterpret_cast<uintptr_t>(&a) + sizeof(a));
+
+	EXPECT_EQ(any_cast<float>(&a), nullptr);
+	EXPECT_THROW(any_cast<float>(a), bad_any_cast);
+
+	a.reset();
+	EXPECT_FALSE(a.has_value());
+	EXPECT_EQ(a.type_id(), any_type_id_of<void>());
+}
+
+TEST(StaticAnyTests, GivenCopyAndMove_ValuesAreConstructedAndDestroyedOnce)
+{
+	Tracked::live = 0;
+	{
+		static_any a(std::in_place_type<Tracked>, 5);
+		static_any b = a;
+		EXPECT_EQ(Tracked::live, 2);
+		EXPECT_EQ(any_cast<const Tracked&>(b).value, 5);
+
+		static_any c = std::move(a);
+		EXPECT_FALSE(a.has_value());
+		EXPECT_EQ(any_cast<const Tracked&>(c).value, 5);
+		EXPECT_EQ(Tracked::live, 2);
+
+		b = 7;
+		EXPECT_EQ(Tracked::live, 1);
+		EXPECT_EQ(any_cast<int>(b), 7);
+	}
+	EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(StaticAnyTests, GivenSwap_ValuesAreExchanged)
+{
+	Tracked::live = 0;
+	{
+		static_any a = 1.5;
+		static_any b(std::in_place_type<Tracked>, 3);
+		swap(a, b);
+		EXPECT_EQ(any_cast<const Tracked&>(a).value, 3);
+		EXPECT_EQ(any_cast<double>(b), 1.5);
+
+		static_any empty;
+		empty.swap(a);
+		EXPECT_FALSE(a.has_value());
+		EXPECT_EQ(any_cast<const Tracked&>(empty).value, 3);
+		EXPECT_EQ(Tracked::live, 1);
+	}
+	EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(StaticAnyTests, GivenSmallerStaticAny_ItConvertsToABiggerOne)
+{
+	basic_static_any<8, 8> small = std::string::size_type{ 9 };
+	basic_static_any<32, 16> big = small;
+	EXPECT_EQ(any_cast<std::string::size_type>(big), 9u);
+
+	basic_static_any<32, 16> moved = std::move(small);
+	EXPECT_FALSE(small.has_value());
+	EXPECT_EQ(any_cast<std::string::size_type>(moved), 9u);
+	static_assert(!std::is_constructible_v<basic_static_any<8, 8>, const basic_static_any<32, 16>&>);
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include "unique_any.h"
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+	// A move-only handle, e.g. a file descriptor
+	struct Handle
+	{
+		explicit Handle(int fd) noexcept : fd{ fd } {}
+		Handle(Handle&& other) noexcept : fd{ std::exchange(other.fd, -1) } {}
+		Handle& operator=(Handle&& other) noexcept { fd = std::exchange(other.fd, -1); return *this; }
+		~Handle() { if (fd != -1) ++closed; }
+
+		static inline int closed = 0;
+		int fd;
+	};
+
+	// Too big for the inline buffer and move-only
+	struct MoveOnlyBuffer
+	{
+		MoveOnlyBuffer() = default;
+		MoveOnlyBuffer(const MoveOnlyBuffer&) = delete;
+		MoveOnlyBuffer(MoveOnlyBuffer&&) = default;
+
+		std::array<char, 128> data{};
+		std::unique_ptr<int> owner;
+	};
+}
+
+TEST(UniqueAnyTests, GivenUniquePtr_ItIsStoredInlineAndCastBack)
+{
+	unique_any a = std::make_unique<int>(42);
+
+	static_assert(unique_any::is_small<std::unique_ptr<int>>::value);
+	ASSERT_TRUE(a.has_value());
+	EXPECT_EQ(a.type_id(), any_type_id_of<std::unique_ptr<int>>());
+	EXPECT_EQ(*any_cast<std::unique_ptr<int>&>(a), 42);
+
+	std::unique_ptr<int> p = any_cast<std::unique_ptr<int>>(std::move(a));
+	EXPECT_EQ(*p, 42);
+}
+
+TEST(UniqueAnyTests, GivenMoveOnlyHandle_DestroyingTheAnyClosesItOnce)
+{
+	Handle::closed = 0;
+	{
+		unique_any a = Handle{ 3 };
+		unique_any b = std::move(a);
+		EXPECT_FALSE(a.has_value());
+		EXPECT_EQ(any_cast<Handle&>(b).fd, 3);
+
+		b = Handle{ 4 };
+		EXPECT_EQ(Handle::closed, 1);
+	}
+	EXPECT_EQ(Handle::closed, 2);
+}
+
+TEST(UniqueAnyTests, GivenBigMoveOnlyValue_MovingTheAnyKeepsTheBlock)
+{
+	unique_any a{ std::in_place_type<MoveOnlyBuffer> };
+	static_assert(!unique_any::is_small<MoveOnlyBuffer>::value);
+
+	const void* block = any_cast<MoveOnlyBuffer>(&a);
+
+	unique_any b = std::move(a);
+	unique_any c;
+	c = std::move(b);
+	swap(a, c);
+
+	EXPECT_EQ(any_cast<MoveOnlyBuffer>(&a), block);
+	EXPECT_FALSE(b.has_value());
+	EXPECT_FALSE(c.has_value());
+}
+
+TEST(UniqueAnyTests, GivenMixedValues_VectorGrowthKeepsThem)
+{
+	std::vector<unique_any> values;
+	for (int i = 0; i < 64; ++i)
+	{
+		if (i % 2)
+		{
+			values.emplace_back(std::make_unique<int>(i));
+		}
+		else
+		{
+			values.emplace_back(std::string(40, static_cast<char>('a' + i % 26)));
+		}
+	}
+
+	for (int i = 0; i < 64; ++i)
+	{
+		if (i % 2)
+		{
+			EXPECT_EQ(*any_cast<std::unique_ptr<int>&>(values[i]), i);
+		}
+		else
+		{
+			EXPECT_EQ(any_cast<std::string&>(values[i])[0], 'a' + i % 26);
+		}
+	}
+}
+
+TEST(UniqueAnyTests, GivenSmallerCapacity_ConvertingSpillsToTheHeap)
+{
+	using Pointers = std::array<std::unique_ptr<int>, 4>;
+
+	basic_unique_any<64, 8> a = Pointers{ std::make_unique<int>(1) };
+	basic_unique_any<16, 8> b = std::move(a);
+
+	EXPECT_FALSE(a.has_value());
+	EXPECT_EQ(*any_cast<Pointers&>(b)[0], 1);
+	EXPECT_EQ(any_cast<int>(&b), nullptr);
+}
+
+TEST(UniqueAnyTests, GivenHandlerTables_TheyHaveNoCopySlot)
+{
+	static_assert(sizeof(unique_any_handler) + sizeof(void*) == sizeof(any_handler));
+	static_assert(!std::is_copy_constructible_v<unique_any>);
+	static_assert(std::is_nothrow_move_constructible_v<unique_any>);
+	static_assert(sizeof(unique_any) == sizeof(any));
+
+	constexpr const unique_any_handler* small = &unique_any_handlers<std::unique_ptr<int>, any_pool_allocator>::small;
+	static_assert(small->_representation == any_representation::Small);
+	static_assert(small->_trivially_relocatable);
+
+	auto value = make_unique_any<std::vector<int>>({ 1, 2, 3 });
+	EXPECT_EQ(any_cast<std::vector<int>&>(value).size(), 3u);
+}
+
+struct NonComparable
+{
+	int x = 0;
+};
+
+TEST(UniqueAnyTests, GivenContainerOfNonComparableType_ItIsStoredWithoutEquality)
+{
+	unique_any values = std::vector<NonComparable>(2);
+	unique_any other = std::vector<NonComparable>(2);
+
+	EXPECT_EQ(any_cast<std::vector<NonComparable>&>(values).size(), 2u);
+	EXPECT_THROW((void)(values == other), bad_any_operation);
+}
+
+TEST(UniqueAnyTests, GivenMoveOnlyKeys_UnorderedSetFindsThemByValue)
+{
+	auto pointer = std::make_unique<int>(1);
+	int* raw = pointer.get();
+
+	std::unordered_set<unique_any> keys;
+	keys.insert(unique_any(std::move(pointer)));
+	keys.insert(unique_any(std::string("key")));
+
+	EXPECT_EQ(std::hash<unique_any>{}(unique_any(std::string("key"))), std::hash<std::string>{}("key"));
+	EXPECT_EQ(keys.count(unique_any(std::string("key"))), 1u);
+	EXPECT_EQ(keys.count(unique_any(42)), 0u);
+
+	// unique_ptr hashes and compares its pointer
+	const size_t hashes = std::count_if(keys.begin(), keys.end(), [&](const unique_any& key)
+	{
+		return key.hash() == std::hash<int*>{}(raw);
+	});
+	EXPECT_EQ(hashes, 1u);
+}
@@ -1,458 +1,1484 @@
-#pragma once
-/*
-	At any point, an <any> stores one of the following types:
-		1. Big types
-		2. Small types
-		3. Trivial types
-
-	In the 1st case, <any> will dynamically allocate memory on the heap for the object
-	In the 2nd case, <any> will store the object inside any itself
-	In the 3rd case, <any> will store the object inside any itself and no destructor shall be called for the object. Additionally, the copy and moves will be treated differently
-*/
-
-#include <utility>
-#include <initializer_list>
-#include <type_traits>
-
-class bad_any_cast : public std::bad_cast
-{
-	const char* what() const noexcept override
-	{
-		return "bad_any_cast";
-	}
-};
-
-constexpr size_t small_space_size = 8 * sizeof(void*);
-
-template<class T>
-using any_is_small = std::bool_constant<std::is_nothrow_move_constructible_v<T>
-									 && sizeof(T) <= small_space_size
-									 && alignof(T) <= alignof(void*)>; // Check if alignment shouldnt be % == 0
-
-enum class any_representation : unsigned char
-{
-	Small,
-	Big,
-};
-
-template<class T, class... Args>
-void Construct(void* destination, Args&&... args)
-{
-	new(destination) T(std::forward<Args>(args)...);
-}
-
-struct any_big
-{
-	template <class T>
-	static void Destroy(void* target) noexcept
-	{
-		std::destroy_at(static_cast<T*>(target));
-
-		_aligned_free(target);
-	}
-
-	template<class T>
-	static void* Copy(const void* source)
-	{
-		return new T(*static_cast<const T*>(source));
-	}
-
-	template<class T>
-	static void* Type()
-	{
-		return (void*)&typeid(T);
-	}
-
-	void (*_destroy)(void*);
-	void* (*_copy)(const void*);
-	void* (*_type)();
-};
-
-struct any_small
-{
-	template <class T>
-	static void Destroy(void* target)
-	{
-		if constexpr (!std::is_trivially_copyable_v<T>)
-		{
-			std::destroy_at(static_cast<T*>(target));
-		}
-	}
-
-	template<class T>
-	static void Copy(void* destination, const void* what)
-	{
-		if constexpr (std::is_trivially_copyable_v<T>)
-		{
-			*static_cast<T*>(destination) = *static_cast<const T*>(what);
-		}
-		else
-		{
-			Construct<T>(static_cast<T*>(destination), *static_cast<const T*>(what));
-		}
-	}
-
-	template<class T>
-	static void Move(void* destination, void* what) noexcept
-	{
-		if constexpr (std::is_trivially_copyable_v<T>)
-		{
-			*static_cast<T*>(destination) = *static_cast<T*>(what);
-		}
-		else
-		{
-			Construct<T>(static_cast<T*>(destination), std::move(*static_cast<T*>(what)));
-		}
-	}
-
-	template<class T>
-	static void* Type()
-	{
-		return (void*) & typeid(T);
-	}
-
-	void (*_destroy)(void*);
-	void (*_copy)(void*, const void*);
-	void (*_move)(void*, void*);
-	void* (*_type)();
-};
-
-template<class T>
-any_big any_big_obj = { &any_big::Destroy<T>, &any_big::Copy<T>, &any_big::Type<T> };
-
-template<class T>
-any_small any_small_obj = { &any_small::Destroy<T>, &any_small::Copy<T>, &any_small::Move<T>, &any_small::Type<T> };
-
-class any
-{
-public:
-	constexpr any() noexcept
-		:_storage{},
-		_representation{}
-	{
-	}
-
-	any(const any& other) noexcept
-		:_storage{},
-		_representation{}
-	{
-		if (!other.has_value())
-		{
-			return;
-		}
-
-		switch (other._representation)
-		{
-		case any_representation::Big:
-			_storage.big_storage.handler = other._storage.big_storage.handler;
-			_storage.big_storage.storage = other._storage.big_storage.handler->_copy(other._storage.big_storage.storage);
-			_representation = any_representation::Big;
-			break;
-		case any_representation::Small:
-			_storage.small_storage.handler = other._storage.small_storage.handler;
-			other._storage.small_storage.handler->_copy(&_storage.small_storage.storage, &other._storage.small_storage.storage);
-			_representation = any_representation::Small;
-			break;
-		}
-	}
-
-	any(any&& other) noexcept
-		:_storage{},
-		_representation{}
-	{
-		if (!other.has_value())
-		{
-			return;
-		}
-
-		switch (other._representation)
-		{
-		case any_representation::Big:
-			_storage.big_storage.handler = other._storage.big_storage.handler;
-			_storage.big_storage.storage = other._storage.big_storage.storage;
-			_representation = any_representation::Big;
-			break;
-		case any_representation::Small:
-			_storage.small_storage.handler = other._storage.small_storage.handler;
-			other._storage.small_storage.handler->_move(&_storage.small_storage.storage, &other._storage.small_storage.storage);
-			_representation = any_representation::Small;
-			break;
-		}
-	}
-
-	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!std::is_same_v<VT, any> // can use conjunction and negation for short circuit but it's too hard to read
-										   && std::is_copy_constructible_v<VT>>> // check if VT is a specialization of in_place_type_t
-	any(T&& value)
-	{
-		emplace<VT>(std::forward<T>(value));
-	}
-
-	template<class T, class... Args, typename VT = std::decay_t<T>, typename = std::enable_if<std::is_copy_constructible_v<VT>
-											       && std::is_constructible_v<VT, Args...>>>
-	explicit any(std::in_place_type_t<T>, Args&&... args)
-	{
-		emplace<VT>(std::forward<T>(args)...);
-	}
-
-	template<class T, class U, class...Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<std::is_copy_constructible_v<VT> 
-													 && std::is_constructible_v<VT, std::initializer_list<U>&, Args...>>>
-	explicit any(std::in_place_type_t<T>, std::initializer_list<U> il, Args&&... args)
-	{
-		emplace<VT>(il, std::forward<Args>(args)...);
-	}
-
-	~any()
-	{
-		reset();
-	}
-	
-	any& operator=(const any& rhs)
-	{
-		any(rhs).swap(*this);
-
-		return *this;
-	}
-
-	any& operator=(any&& rhs) noexcept
-	{
-		any(std::move(rhs)).swap(*this);
-		return *this;
-	}
-
-	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!std::is_same_v<VT, any>
-										   && std::is_copy_constructible_v<VT>>>
-	any& operator=(T&& rhs)
-	{
-		any tmp(std::forward<T>(rhs));
-
-		tmp.swap(*this);
-
-		return *this;
-	}
-	
-	template<class T, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
-												 && std::is_constructible_v<VT, Args...>>>
-	std::decay_t<T>& emplace(Args&&... args)
-	{
-		reset();
-		auto t = std::is_nothrow_move_constructible_v<T>;
-		auto s = sizeof(T);
-		auto a = alignof(T);
-		auto av = alignof(void*);
-		return emplace_impl<VT>(any_is_small<T>{}, std::forward<Args>(args)...);
-	}
-	
-	template<class T, class U, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
-													  && std::is_constructible_v<VT,std::initializer_list<U>&, Args...>>>
-	std::decay_t<T>& emplace(std::initializer_list<U> il, Args&&... args)
-	{
-		reset();
-		auto t = std::is_nothrow_move_constructible_v<T>;
-		auto s = sizeof(T);
-		auto a = alignof(T);
-		return emplace_impl<VT>(any_is_small<T>{}, il, std::forward<Args>(args)...);
-	}
-
-	void reset() noexcept
-	{
-		if (!has_value())
-		{
-			return;
-		}
-
-		switch (_representation)
-		{
-		case any_representation::Big:
-			_storage.big_storage.handler->_destroy(_storage.big_storage.storage);
-			_storage.big_storage.handler = nullptr;
-			break;
-		case any_representation::Small:
-			_storage.small_storage.handler->_destroy(&_storage.small_storage.storage);
-			_storage.small_storage.handler = nullptr;
-			break;
-		}
-	}
-
-	void swap(any& rhs) noexcept
-	{
-		std::swap(_storage, rhs._storage);
-		std::swap(_representation, rhs._representation);
-	}
-
-	bool has_value() const noexcept
-	{
-		switch (_representation)
-		{
-		case any_representation::Big:
-			return _storage.big_storage.handler != nullptr;
-		case any_representation::Small:
-			return _storage.small_storage.handler != nullptr;
-		default:
-			return false;
-		}
-	}
-	const std::type_info& type() const noexcept
-	{
-		if (has_value())
-		{
-			switch (_representation)
-			{
-				case any_representation::Big:
-					return *static_cast<const std::type_info*>(_storage.big_storage.handler->_type());
-				case any_representation::Small:
-					return *static_cast<const std::type_info*>(_storage.small_storage.handler->_type());
-			}
-		}
-		else
-		{
-			return typeid(void);
-		}
-	}
-
-	template<class T>
-	T* get_val() noexcept
-	{
-		return static_cast<T*>(get_val_impl(any_is_small<T>{}));
-	}
-
-private:
-	template<class T, class... Args>
-	std::decay_t<T>& emplace_impl(std::true_type, Args&&... args) // any_is_trivial, any_is_small
-	{
-		// small any
-		_storage.small_storage.handler = &any_small_obj<T>;
-		Construct<T>(static_cast<void*>(&_storage.small_storage.storage), std::forward<Args>(args)...);
-		_representation = any_representation::Small;
-		return reinterpret_cast<T&>(_storage.small_storage.storage);
-	}
-
-	template<class T, class... Args>
-	std::decay_t<T>& emplace_impl(std::false_type, Args&&... args) // any_is_trivial, any_is_small
-	{
-		// big any
-		_storage.big_storage.handler = &any_big_obj<T>;
-		_storage.big_storage.storage = _aligned_malloc(sizeof(T), alignof(T));
-		Construct<T>(_storage.big_storage.storage, std::forward<Args>(args)...);
-		_representation = any_representation::Big;
-		return reinterpret_cast<T&>(_storage.big_storage.storage);
-	}
-
-	void* get_val_impl(std::true_type) noexcept
-	{
-		return (static_cast<void*>(&_storage.small_storage.storage));
-	}
-
-	void* get_val_impl(std::false_type) noexcept
-	{
-		return (_storage.big_storage.storage);
-	}
-
-	struct big_storage_t
-	{
-		void* storage;
-		any_big* handler;
-	};
-
-	struct small_storage_t
-	{
-		typedef std::aligned_storage_t<small_space_size, std::alignment_of_v<void*>> internal_storage_t;
-		internal_storage_t storage;
-		any_small* handler;
-	};
-
-	struct storage
-	{
-		union
-		{
-			small_storage_t small_storage;
-			big_storage_t big_storage;
-		};
-	};
-
-	storage _storage;
-	any_representation _representation;
-};
-
-inline void swap(any& x, any& y) noexcept 
-{
-	x.swap(y);
-}
-
-template<class T, class... Args>
-any make_any(Args&&... args)
-{
-	return any{std::in_place_type<T>, std::forward<Args>(args)...};
-}
-
-template<class T, class U, class... Args>
-any make_any(std::initializer_list<U> il, Args&&... args)
-{
-	return make_any(il, std::forward<Args>(args)...);
-}
-
-template<class T>
-T any_cast(const any& operand)
-{
-	static_assert(std::is_constructible_v<T, const std::remove_cv_t<std::remove_reference_t<T>>&>);
-
-	const auto storagePtr = any_cast<std::remove_cv_t<std::remove_reference_t<T>>>(&operand);
-
-	if (!storagePtr)
-	{
-		throw bad_any_cast({});
-	}
-
-	return static_cast<T>(*storagePtr);
-}
-
-template<class T>
-T any_cast(any& operand)
-{
-	static_assert(std::is_constructible_v<T, std::remove_cv_t<std::remove_reference_t<T>>&>);
-
-	const auto storagePtr = any_cast<std::remove_cv_t<std::remove_reference_t<T>>>(&operand);
-
-	if (!storagePtr)
-	{
-		throw bad_any_cast({});
-	}
-
-	return static_cast<T>(*storagePtr);
-}
-
-template<class T>
-T any_cast(any&& operand)
-{
-	static_assert(std::is_constructible_v<T, std::remove_cv_t<std::remove_reference_t<T>>>);
-
-	const auto storagePtr = any_cast<std::remove_cv_t<std::remove_reference_t<T>>>(&operand);
-
-	if (!storagePtr)
-	{
-		throw bad_any_cast({});
-	}
-
-	return static_cast<T>(std::move(*storagePtr));
-}
-
-template<class T>
-const T* any_cast(const any* operand) noexcept
-{
-	if (operand != nullptr && operand->type() == typeid(T))
-	{
-		return /*const_cast*/ operand->get_val<T>();
-	}
-
-	return nullptr;
-}
-
-template<class T>
-T* any_cast(/*const*/ any* operand) noexcept
-{
-	if (operand != nullptr && operand->type() == typeid(T))
-	{
-		return /*const_cast*/ operand->get_val<T>();
-	}
-
-	return nullptr;
-}
+#pragma once
+/*
+	At any point, an <any> stores one of the following types:
+		1. Big types
+		2. Small types
+		3. Trivial types
+
+	In the 1st case, <any> will dynamically allocate memory on the heap for the object
+	In the 2nd case, <any> will store the object inside any itself
+	In the 3rd case, <any> will store the object inside any itself and no destructor shall be called for the object. Additionally, the copy and moves will be treated differently
+
+	<any> is an alias of basic_any<Capacity, Align> which decides how big the inline buffer is and how strictly it is aligned.
+	Types aligned stricter than Align always go on the heap, aligned_any<16/32/64> keeps them inline.
+	Values can be moved between any two basic_any instantiations that share an allocator type,
+	and they only touch the heap when the value doesn't fit inside the destination's buffer.
+
+	Every type has two constant initialized handler tables, any_handlers<T, Alloc>::small and ::big, and the table knows
+	the representation. An any is just its buffer and a pointer to the table: no value means no table, and every
+	operation is one indirect call through it. For big values the buffer holds the pointer to the heap block.
+
+	Big types are allocated through the Alloc parameter of basic_any. Alloc only needs:
+		void* allocate(size_t size, size_t align);
+		void deallocate(void* block, size_t size, size_t align) noexcept;
+		bool operator==(const Alloc&) const noexcept;
+		using is_always_equal = std::true_type / std::false_type;
+	The default is any_pool_allocator (any_pool.h), which keeps thread-local free lists per size class, any_heap_allocator
+	goes straight to the global heap.
+	The allocator travels with the value on copy construction, move construction and swap. Assignment keeps the
+	allocator of the left hand side and re-allocates the value in it when the two allocators differ.
+
+	Assigning or emplacing a value of the type the any already holds assigns it in place, and emplacing a big value
+	reuses the current heap block when the allocator can free it as a block of the new size (see any_allocator_traits).
+	pmr::any routes the big path through a std::pmr::memory_resource.
+
+	Types with a std::hash get a _hash slot in their tables, equality comparable ones (any_is_equality_comparable) an
+	_equal slot, which gives basic_any a std::hash and an operator== of its own: one type check and one indirect call, so
+	anys can key unordered containers.
+
+	Extra operations can be added to the tables too (see any_operation): any_with<print> calls print on whatever it
+	holds through its table, value semantics and no base class required.
+
+	Building with ANY_ENABLE_STATS=1 counts emplaces, allocations, copies, moves and failed casts per type (any_stats.h).
+
+	With C++20 (ANY_HAS_CONSTEXPR), constructing, copying, destroying and any_cast<T> by value work in constant
+	evaluation for small trivially copyable types, so tables of anys can be constexpr or constinit and cost nothing at
+	startup. The value is kept as its bytes through std::bit_cast, which rules out types with pointers or padding there.
+
+	Moves and swaps copy the bytes when the contained type is trivially relocatable (see is_trivially_relocatable below),
+	anything else is moved through its handler. relocatable_any only stores relocatable types inline, which makes the
+	any itself trivially relocatable.
+*/
+
+#include <utility>
+#include <initializer_list>
+#include <type_traits>
+#include <new>
+#include <memory>
+#include <memory_resource>
+#include <typeinfo>
+#include <cstring>
+#include <tuple>
+#include <variant>
+
+#include "any_pool.h"
+#include "any_stats.h"
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+// RTTI is only needed for any::type(). Casting compares any_type_ids, so -fno-rtti / /GR- builds work.
+#ifndef ANY_HAS_RTTI
+#if defined(__cpp_rtti) || defined(__GXX_RTTI) || defined(_CPPRTTI)
+#define ANY_HAS_RTTI 1
+#else
+#define ANY_HAS_RTTI 0
+#endif
+#endif
+
+// C++20 lets small trivially copyable values be stored and read back in constant evaluation, see basic_any below.
+#ifndef ANY_HAS_CONSTEXPR
+#if defined(__cpp_lib_bit_cast) && defined(__cpp_lib_is_constant_evaluated) && defined(__cpp_constexpr_dynamic_alloc)
+#define ANY_HAS_CONSTEXPR 1
+#else
+#define ANY_HAS_CONSTEXPR 0
+#endif
+#endif
+
+#if ANY_HAS_CONSTEXPR
+#include <bit>
+#define ANY_CONSTEXPR constexpr
+#else
+#define ANY_CONSTEXPR
+#endif
+
+class bad_any_cast : public std::bad_cast
+{
+	const char* what() const noexcept override
+	{
+		return "bad_any_cast";
+	}
+};
+
+// Thrown when hashing or comparing a value whose type has no std::hash or isn't any_is_equality_comparable.
+class bad_any_operation : public std::exception
+{
+	const char* what() const noexcept override
+	{
+		return "bad_any_operation";
+	}
+};
+
+constexpr size_t small_space_size = 8 * sizeof(void*);
+constexpr size_t small_space_align = alignof(void*);
+
+// P1144 style opt-in: moving a T and destroying the source is equivalent to copying its bytes.
+// Specialize it for your own types, most types that don't point into themselves qualify.
+template<class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template<class T, class D>
+struct is_trivially_relocatable<std::unique_ptr<T, D>> : is_trivially_relocatable<D> {};
+
+template<class T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+template<class T>
+constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+template<class T, size_t Capacity = small_space_size, size_t Align = small_space_align, bool RelocatableOnly = false>
+using any_is_small = std::bool_constant<std::is_nothrow_move_constructible_v<T>
+									 && sizeof(T) <= Capacity
+									 && alignof(T) <= Align // alignments are powers of two so <= means Align % alignof(T) == 0
+									 && (!RelocatableOnly || is_trivially_relocatable_v<T>)>;
+
+// The address of a per-type tag, unique per type within a binary (but not across DLL boundaries).
+// cv-qualifiers are dropped like typeid does, so any_cast<const T> finds a T.
+using any_type_id = const void*;
+
+template<class T>
+struct any_type_tag
+{
+	static inline char id; // not const, identical read-only data may get folded together by the linker (/OPT:ICF)
+};
+
+template<class T>
+constexpr any_type_id any_type_id_of() noexcept
+{
+	return &any_type_tag<std::remove_cv_t<T>>::id;
+}
+
+#if ANY_ENABLE_STATS
+template<class T>
+const char* any_type_name() noexcept
+{
+#if ANY_HAS_RTTI
+	return typeid(T).name();
+#else
+	return "";
+#endif
+}
+
+template<class T>
+struct any_stats_of
+{
+	static inline any_type_stats record{ any_type_id_of<T>(), sizeof(T), alignof(T), &any_type_name<T> };
+};
+
+#define ANY_STATS_COUNT_TYPE(T, counter, n) ANY_STATS_COUNT(&any_stats_of<std::remove_cv_t<T>>::record, counter, n)
+#else
+#define ANY_STATS_COUNT_TYPE(T, counter, n) ((void)0)
+#endif
+
+enum class any_representation : unsigned char
+{
+	Small,
+	Big,
+};
+
+template<class T, class... Args>
+void Construct(void* destination, Args&&... args)
+{
+	new(destination) T(std::forward<Args>(args)...);
+}
+
+template<class T, class = void>
+struct any_is_hashable : std::false_type {};
+
+template<class T>
+struct any_is_hashable<T, std::void_t<decltype(static_cast<size_t>(std::hash<T>{}(std::declval<const T&>())))>> : std::true_type {};
+
+template<class T, class = void>
+struct any_has_operator_equal : std::false_type {};
+
+template<class T>
+struct any_has_operator_equal<T, std::void_t<decltype(static_cast<bool>(std::declval<const T&>() == std::declval<const T&>()))>> : std::true_type {};
+
+/*
+	Whether an any holding a T compares it with operator==, true when T has one. Only a declared operator== can be
+	detected, and std::vector<T>, std::optional<T>, std::pair, std::tuple and std::variant declare one for every T that
+	only fails to compile once it's instantiated, which the tables would do for every stored type. So types with a
+	value_type (containers, strings, std::optional) also need their value_type to be comparable, and pairs, tuples and
+	variants their members. Specialize it as std::false_type for a type whose operator== is declared but broken in the
+	same way. Comparing two anys holding a T without it throws bad_any_operation.
+*/
+template<class T, class = void>
+struct any_is_equality_comparable : any_has_operator_equal<T> {};
+
+template<class T>
+struct any_is_equality_comparable<T, std::void_t<typename T::value_type>>
+	: std::conjunction<any_has_operator_equal<T>, std::disjunction<std::is_same<std::remove_cv_t<typename T::value_type>, T>,
+																   any_is_equality_comparable<std::remove_cv_t<typename T::value_type>>>> {};
+
+template<class First, class Second>
+struct any_is_equality_comparable<std::pair<First, Second>> : std::conjunction<any_is_equality_comparable<std::remove_cv_t<First>>, any_is_equality_comparable<std::remove_cv_t<Second>>> {};
+
+template<class... Ts>
+struct any_is_equality_comparable<std::tuple<Ts...>> : std::conjunction<any_is_equality_comparable<std::remove_cv_t<Ts>>...> {};
+
+template<class... Ts>
+struct any_is_equality_comparable<std::variant<Ts...>> : std::conjunction<any_is_equality_comparable<std::remove_cv_t<Ts>>...> {};
+
+// The operations work on the any's storage: the object itself for small values, a pointer to the heap block for big ones.
+// Small operations ignore the allocator, so they can be pointed at any object of their type.
+struct any_handler
+{
+	void (*_destroy)(void* storage, void* alloc) noexcept;
+	void (*_copy)(void* destination, const void* source, void* alloc);
+	void (*_move)(void* destination, void* source) noexcept; // leaves <source> without a value
+	void (*_relocate)(void* destination, void* source); // object to object, used when a value changes representation or allocator
+	any_type_id _id;
+	size_t _size;
+	size_t _align;
+	any_representation _representation;
+	bool _trivially_relocatable; // the storage, so always true for big values
+	bool _trivially_copyable; // small trivially copyable values, copied with a memcpy and destroyed by dropping them
+	const any_handler* _small; // same type and allocator, small representation. nullptr if the type can never be stored inline
+	const any_handler* _big; // same type and allocator, big representation
+	size_t (*_hash)(const void* object); // nullptr if T has no std::hash
+	bool (*_equal)(const void* object, const void* other); // nullptr unless any_is_equality_comparable<T>
+#if ANY_HAS_RTTI
+	const std::type_info& (*_type)() noexcept;
+#endif
+#if ANY_ENABLE_STATS
+	any_type_stats* _stats;
+#endif
+
+	void* object(void* storage) const noexcept
+	{
+		return _representation == any_representation::Big ? *static_cast<void**>(storage) : storage;
+	}
+
+	const void* object(const void* storage) const noexcept
+	{
+		return _representation == any_representation::Big ? *static_cast<void* const*>(storage) : storage;
+	}
+
+	// Whether a buffer of <capacity>/<align> can hold the value inline.
+	bool fits(size_t capacity, size_t align, bool relocatable_only) const noexcept
+	{
+		return _small && _size <= capacity && _align <= align && (!relocatable_only || _small->_trivially_relocatable);
+	}
+};
+
+struct any_small
+{
+	template <class T>
+	static void Destroy(void* target, void*) noexcept
+	{
+		if constexpr (!std::is_trivially_copyable_v<T>)
+		{
+			std::destroy_at(static_cast<T*>(target));
+		}
+	}
+
+	template<class T>
+	static void Copy(void* destination, const void* what, void*)
+	{
+		ANY_STATS_COUNT_TYPE(T, copies, 1);
+
+		if constexpr (std::is_trivially_copyable_v<T>)
+		{
+			*static_cast<T*>(destination) = *static_cast<const T*>(what);
+		}
+		else
+		{
+			Construct<T>(static_cast<T*>(destination), *static_cast<const T*>(what));
+		}
+	}
+
+	template<class T>
+	static void Move(void* destination, void* what) noexcept
+	{
+		ANY_STATS_COUNT_TYPE(T, moves, 1);
+
+		if constexpr (std::is_trivially_copyable_v<T>)
+		{
+			std::memcpy(destination, what, sizeof(T)); // trivially copyable doesn't imply copy assignable
+		}
+		else
+		{
+			Construct<T>(static_cast<T*>(destination), std::move(*static_cast<T*>(what)));
+			std::destroy_at(static_cast<T*>(what));
+		}
+	}
+};
+
+struct any_big
+{
+	// Without an allocator the block is kept, emplace reuses it.
+	template <class T, class Alloc>
+	static void Destroy(void* storage, void* alloc) noexcept
+	{
+		T* target = *static_cast<T**>(storage);
+		std::destroy_at(target);
+		if (alloc)
+		{
+			static_cast<Alloc*>(alloc)->deallocate(target, sizeof(T), alignof(T));
+		}
+	}
+
+	template<class T, class Alloc>
+	static void Copy(void* destination, const void* source, void* alloc)
+	{
+		ANY_STATS_COUNT_TYPE(T, copies, 1);
+		ANY_STATS_COUNT_TYPE(T, bytes_allocated, sizeof(T));
+
+		Alloc& allocator = *static_cast<Alloc*>(alloc);
+		void* block = allocator.allocate(sizeof(T), alignof(T));
+		try
+		{
+			Construct<T>(block, **static_cast<const T* const*>(source));
+		}
+		catch (...)
+		{
+			allocator.deallocate(block, sizeof(T), alignof(T));
+			throw;
+		}
+		*static_cast<void**>(destination) = block;
+	}
+
+	// the block changes owner, the allocators are known to be equal
+	template<class T>
+	static void Move(void* destination, void* source) noexcept
+	{
+		ANY_STATS_COUNT_TYPE(T, moves, 1);
+
+		*static_cast<void**>(destination) = *static_cast<void**>(source);
+	}
+
+	// unlike any_small::Move this one may throw, big types don't need a noexcept move
+	template<class T>
+	static void Relocate(void* destination, void* source)
+	{
+		ANY_STATS_COUNT_TYPE(T, moves, 1);
+
+		Construct<T>(destination, std::move(*static_cast<T*>(source)));
+		std::destroy_at(static_cast<T*>(source));
+	}
+};
+
+// Shared by both representations, they take the objects.
+struct any_compare
+{
+	template<class T>
+	static size_t Hash(const void* object)
+	{
+		return std::hash<T>{}(*static_cast<const T*>(object));
+	}
+
+	template<class T>
+	static bool Equal(const void* object, const void* other)
+	{
+		return static_cast<bool>(*static_cast<const T*>(object) == *static_cast<const T*>(other));
+	}
+
+	template<class T>
+	static constexpr auto hash_or_null() noexcept -> size_t (*)(const void*)
+	{
+		if constexpr (any_is_hashable<T>::value)
+		{
+			return &Hash<T>;
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+
+	template<class T>
+	static constexpr auto equal_or_null() noexcept -> bool (*)(const void*, const void*)
+	{
+		if constexpr (any_is_equality_comparable<T>::value)
+		{
+			return &Equal<T>;
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+};
+
+/*
+	User defined operations, stored in the handler tables next to the built-in ones. An operation derives from
+	any_operation<Signature>, where a const signature takes the value by const&, and has a static apply() that does
+	the work for a T:
+
+		struct print : any_operation<void(std::ostream&) const>
+		{
+			template<class T>
+			static void apply(const T& self, std::ostream& out) { out << self; }
+		};
+
+	any_with<print> (or basic_any<Capacity, Align, Alloc, RelocatableOnly, print, ...>) only accepts types print can be
+	applied to, and a.call<print>(std::cout) is one indirect call through the table, without casting a.
+*/
+template<class Signature>
+struct any_operation;
+
+template<class R, class... Args>
+struct any_operation<R(Args...)>
+{
+	using function = R (*)(void* self, Args... args);
+	static constexpr bool is_const = false;
+
+	template<class Op, class T>
+	static R erased(void* self, Args... args)
+	{
+		return Op::apply(*static_cast<T*>(self), std::forward<Args>(args)...);
+	}
+};
+
+template<class R, class... Args>
+struct any_operation<R(Args...) const>
+{
+	using function = R (*)(const void* self, Args... args);
+	static constexpr bool is_const = true;
+
+	template<class Op, class T>
+	static R erased(const void* self, Args... args)
+	{
+		return Op::apply(*static_cast<const T*>(self), std::forward<Args>(args)...);
+	}
+};
+
+template<class Op>
+struct any_operation_slot
+{
+	typename Op::function _function; // takes the object, like _hash and _equal
+};
+
+// any_handler followed by the user's operations, what the tables of a basic_any with operations are.
+template<class... Ops>
+struct any_ops_handler : any_handler, any_operation_slot<Ops>...
+{
+	template<class Op>
+	constexpr typename Op::function get() const noexcept
+	{
+		return static_cast<const any_operation_slot<Op>&>(*this)._function;
+	}
+};
+
+template<class... Ops>
+struct any_handler_for
+{
+	using type = any_ops_handler<Ops...>;
+
+	template<class T>
+	static constexpr type make(const any_handler& handler) noexcept
+	{
+		return { handler, { &Ops::template erased<Ops, T> }... };
+	}
+};
+
+template<>
+struct any_handler_for<>
+{
+	using type = any_handler;
+
+	template<class T>
+	static constexpr type make(const any_handler& handler) noexcept
+	{
+		return handler;
+	}
+};
+
+#if ANY_HAS_RTTI
+template<class T>
+const std::type_info& any_type() noexcept
+{
+	return typeid(T);
+}
+#endif
+
+template<class T, class Alloc, class... Ops>
+struct any_handlers
+{
+	using handler_type = typename any_handler_for<Ops...>::type;
+
+	static const handler_type small;
+	static const handler_type big;
+
+	static constexpr const any_handler* small_or_null() noexcept
+	{
+		if constexpr (std::is_nothrow_move_constructible_v<T>)
+		{
+			return &small;
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+};
+
+template<class T, class Alloc, class... Ops>
+constexpr typename any_handlers<T, Alloc, Ops...>::handler_type any_handlers<T, Alloc, Ops...>::small = any_handler_for<Ops...>::template make<T>({
+	&any_small::Destroy<T>, &any_small::Copy<T>, &any_small::Move<T>, &any_small::Move<T>,
+	any_type_id_of<T>(), sizeof(T), alignof(T), any_representation::Small, is_trivially_relocatable_v<T>, std::is_trivially_copyable_v<T>, &any_handlers<T, Alloc, Ops...>::small, &any_handlers<T, Alloc, Ops...>::big,
+	any_compare::hash_or_null<T>(), any_compare::equal_or_null<T>()
+#if ANY_HAS_RTTI
+	, &any_type<T>
+#endif
+#if ANY_ENABLE_STATS
+	, &any_stats_of<T>::record
+#endif
+});
+
+template<class T, class Alloc, class... Ops>
+constexpr typename any_handlers<T, Alloc, Ops...>::handler_type any_handlers<T, Alloc, Ops...>::big = any_handler_for<Ops...>::template make<T>({
+	&any_big::Destroy<T, Alloc>, &any_big::Copy<T, Alloc>, &any_big::Move<T>, &any_big::Relocate<T>,
+	any_type_id_of<T>(), sizeof(T), alignof(T), any_representation::Big, true, false, any_handlers<T, Alloc, Ops...>::small_or_null(), &any_handlers<T, Alloc, Ops...>::big,
+	any_compare::hash_or_null<T>(), any_compare::equal_or_null<T>()
+#if ANY_HAS_RTTI
+	, &any_type<T>
+#endif
+#if ANY_ENABLE_STATS
+	, &any_stats_of<T>::record
+#endif
+});
+
+// Whether a block Alloc allocated for <size>/<align> can hold an object of <other_size>/<other_align> and be freed as
+// one. Only when they're equal, unless Alloc knows better and has a static interchangeable() saying so.
+template<class Alloc, class = void>
+struct any_allocator_traits
+{
+	static constexpr bool interchangeable(size_t size, size_t align, size_t other_size, size_t other_align) noexcept
+	{
+		return size == other_size && align == other_align;
+	}
+};
+
+template<class Alloc>
+struct any_allocator_traits<Alloc, std::void_t<decltype(Alloc::interchangeable(size_t{}, size_t{}, size_t{}, size_t{}))>>
+{
+	static constexpr bool interchangeable(size_t size, size_t align, size_t other_size, size_t other_align) noexcept
+	{
+		return Alloc::interchangeable(size, align, other_size, other_align);
+	}
+};
+
+struct any_heap_allocator
+{
+	using is_always_equal = std::true_type;
+
+	void* allocate(size_t size, size_t align)
+	{
+		return ::operator new(size, std::align_val_t{ align });
+	}
+
+	void deallocate(void* block, size_t size, size_t align) noexcept
+	{
+		::operator delete(block, size, std::align_val_t{ align });
+	}
+
+	bool operator==(const any_heap_allocator&) const noexcept
+	{
+		return true;
+	}
+};
+
+class any_resource_allocator
+{
+public:
+	using is_always_equal = std::false_type;
+
+	any_resource_allocator() noexcept
+		:_resource(std::pmr::get_default_resource())
+	{
+	}
+
+	any_resource_allocator(std::pmr::memory_resource* resource) noexcept
+		:_resource(resource)
+	{
+	}
+
+	void* allocate(size_t size, size_t align)
+	{
+		return _resource->allocate(size, align);
+	}
+
+	void deallocate(void* block, size_t size, size_t align) noexcept
+	{
+		_resource->deallocate(block, size, align);
+	}
+
+	std::pmr::memory_resource* resource() const noexcept
+	{
+		return _resource;
+	}
+
+	bool operator==(const any_resource_allocator& rhs) const noexcept
+	{
+		return _resource == rhs._resource || _resource->is_equal(*rhs._resource);
+	}
+
+private:
+	std::pmr::memory_resource* _resource;
+};
+
+/*
+	What basic_any, basic_unique_any (unique_any.h) and basic_shared_any (shared_any.h) have in common: the storage,
+	which is the allocator, the buffer and a pointer to a Handler table, relocation between two of them, emplacing, and
+	the any_cast overloads at the end of this file.
+
+	Derived is the any itself. any_cast reads the value through its get_val<T>() and emplace takes the tables from its
+	handlers<T>, so an any only changes what differs: basic_any copies, basic_unique_any has no _copy in its Handler,
+	basic_shared_any counts references to its big values. Members are only instantiated when a Derived uses them, a
+	Handler needs no more than what its any calls.
+*/
+template<class Derived, class Handler, size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly>
+class any_storage
+{
+	static_assert(Capacity >= sizeof(void*), "the inline buffer must be able to hold at least a pointer");
+	static_assert(Align >= alignof(void*) && (Align & (Align - 1)) == 0, "Align must be a power of two no smaller than alignof(void*)");
+
+	template<class, class, size_t, size_t, class, bool>
+	friend class any_storage;
+
+public:
+	static constexpr size_t capacity = Capacity;
+	static constexpr size_t alignment = Align;
+
+	using allocator_type = Alloc;
+
+	template<class T>
+	using is_small = any_is_small<T, Capacity, Align, RelocatableOnly>;
+
+	any_storage(const any_storage&) = delete;
+	any_storage& operator=(const any_storage&) = delete;
+
+	void reset() noexcept
+	{
+		if (has_value())
+		{
+			_storage.handler->_destroy(buffer(), &allocator());
+			_storage.handler = nullptr;
+		}
+	}
+
+	// Swaps the allocators along with the values, so big values never change allocators here.
+	// The bytes are only swapped when both sides are relocatable, otherwise the small values are moved through their handlers.
+	void swap(Derived& other) noexcept
+	{
+		any_storage& rhs = other;
+
+		if (is_relocatable(_storage) && is_relocatable(rhs._storage))
+		{
+			std::swap(_storage, rhs._storage);
+			return;
+		}
+
+		storage tmp{ rhs.get_allocator() };
+		relocate(tmp, rhs._storage);
+		relocate(rhs._storage, _storage);
+		relocate(_storage, tmp);
+	}
+
+	ANY_CONSTEXPR Alloc get_allocator() const noexcept
+	{
+		return _storage;
+	}
+
+	constexpr bool has_value() const noexcept
+	{
+		return _storage.handler != nullptr;
+	}
+
+	constexpr any_type_id type_id() const noexcept
+	{
+		return has_value() ? _storage.handler->_id : any_type_id_of<void>();
+	}
+
+#if ANY_HAS_RTTI
+	const std::type_info& type() const noexcept
+	{
+		return has_value() ? _storage.handler->_type() : typeid(void);
+	}
+#endif
+
+	template<class T>
+	T* get_val() noexcept
+	{
+		return static_cast<T*>(get_val_impl(is_small<T>{}));
+	}
+
+	template<class T>
+	const T* get_val() const noexcept
+	{
+		return const_cast<any_storage*>(this)->template get_val<T>();
+	}
+
+protected:
+	struct storage;
+
+	constexpr any_storage() noexcept
+		:_storage{}
+	{
+	}
+
+	ANY_CONSTEXPR any_storage(const Alloc& alloc) noexcept
+		:_storage{ alloc }
+	{
+	}
+
+	// std::hash of the value, 0 without one. Throws bad_any_operation if its type has no std::hash.
+	size_t hash() const
+	{
+		const Handler* handler = _storage.handler;
+
+		if (!handler)
+		{
+			return 0;
+		}
+
+		if (!handler->_hash)
+		{
+			throw bad_any_operation{};
+		}
+
+		return handler->_hash(handler->object(buffer()));
+	}
+
+	// Equal when both are empty, or hold values of the same type that compare equal. Throws bad_any_operation if the
+	// type isn't any_is_equality_comparable.
+	static bool equal(const any_storage& lhs, const any_storage& rhs)
+	{
+		const Handler* handler = lhs._storage.handler;
+
+		if (lhs.type_id() != rhs.type_id())
+		{
+			return false;
+		}
+
+		if (!handler)
+		{
+			return true;
+		}
+
+		if (!handler->_equal)
+		{
+			throw bad_any_operation{};
+		}
+
+		return handler->_equal(handler->object(lhs.buffer()), rhs._storage.handler->object(rhs.buffer()));
+	}
+
+	Alloc& allocator() noexcept
+	{
+		return _storage;
+	}
+
+	void* buffer() noexcept
+	{
+		return _storage.buffer;
+	}
+
+	const void* buffer() const noexcept
+	{
+		return _storage.buffer;
+	}
+
+	static bool is_relocatable(const storage& s) noexcept
+	{
+		return !s.handler || s.handler->_trivially_relocatable;
+	}
+
+	// Moves the allocator and the value of <source> into <destination>, which holds no value. <source> is left without one.
+	static void relocate(storage& destination, storage& source) noexcept
+	{
+		static_cast<Alloc&>(destination) = static_cast<const Alloc&>(source);
+
+		if (is_relocatable(source))
+		{
+			std::memcpy(destination.buffer, source.buffer, Capacity);
+			if (source.handler)
+			{
+				ANY_STATS_COUNT(source.handler->_stats, moves, 1);
+			}
+		}
+		else
+		{
+			source.handler->_move(destination.buffer, source.buffer);
+		}
+
+		destination.handler = source.handler;
+		source.handler = nullptr;
+	}
+
+	// Expects our allocator to be set already. Big blocks are stolen when they don't fit inline and the allocators agree.
+	template<class OtherDerived, size_t OtherCapacity, size_t OtherAlign, bool OtherRelocatableOnly>
+	void move_from(any_storage<OtherDerived, Handler, OtherCapacity, OtherAlign, Alloc, OtherRelocatableOnly>& other)
+	{
+		const Handler* handler = other._storage.handler;
+
+		if (!handler)
+		{
+			return;
+		}
+
+		const Handler* target = handler->fits(Capacity, Align, RelocatableOnly) ? handler->_small : handler->_big;
+		void* object = handler->object(other.buffer());
+
+		if (target == handler && (target->_representation == any_representation::Small || allocator() == other.allocator()))
+		{
+			handler->_move(buffer(), other.buffer());
+		}
+		else if (target->_representation == any_representation::Small)
+		{
+			target->_move(buffer(), object);
+			other.allocator().deallocate(object, handler->_size, handler->_align);
+		}
+		else
+		{
+			void* block = allocator().allocate(target->_size, target->_align);
+			ANY_STATS_COUNT(target->_stats, bytes_allocated, target->_size);
+			try
+			{
+				handler->_relocate(block, object);
+			}
+			catch (...)
+			{
+				allocator().deallocate(block, target->_size, target->_align);
+				throw;
+			}
+
+			if (handler->_representation == any_representation::Big)
+			{
+				other.allocator().deallocate(object, handler->_size, handler->_align);
+			}
+			*static_cast<void**>(buffer()) = block;
+		}
+
+		other._storage.handler = nullptr;
+		_storage.handler = target;
+	}
+
+	// Replaces our value, a big one reuses the heap block of the old one when it can.
+	template<class T, class... Args>
+	T& emplace_impl(Args&&... args)
+	{
+		if constexpr (is_small<T>::value)
+		{
+			reset();
+			return emplace_small<T>(std::forward<Args>(args)...);
+		}
+		else
+		{
+			ANY_STATS_COUNT_TYPE(T, big_emplaces, 1);
+			void* block = reuse_block(sizeof(T), alignof(T));
+			if (!block)
+			{
+				ANY_STATS_COUNT_TYPE(T, bytes_allocated, sizeof(T));
+				block = allocator().allocate(sizeof(T), alignof(T));
+			}
+			try
+			{
+				Construct<T>(block, std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				allocator().deallocate(block, sizeof(T), alignof(T));
+				throw;
+			}
+			*static_cast<void**>(buffer()) = block;
+			_storage.handler = &Derived::template handlers<T>::big;
+			return *static_cast<T*>(block);
+		}
+	}
+
+	// Expects no value.
+	template<class T, class... Args>
+	T& emplace_small(Args&&... args)
+	{
+		ANY_STATS_COUNT_TYPE(T, small_emplaces, 1);
+		Construct<T>(buffer(), std::forward<Args>(args)...);
+		_storage.handler = &Derived::template handlers<T>::small;
+		return *static_cast<T*>(buffer());
+	}
+
+	// Destroys our value. Returns its heap block when it can serve as one of <size>/<align>, nullptr after freeing it otherwise.
+	void* reuse_block(size_t size, size_t align) noexcept
+	{
+		const Handler* handler = _storage.handler;
+
+		if (handler && handler->_representation == any_representation::Big
+			&& any_allocator_traits<Alloc>::interchangeable(handler->_size, handler->_align, size, align))
+		{
+			handler->_destroy(buffer(), nullptr);
+			_storage.handler = nullptr;
+			return *static_cast<void**>(buffer());
+		}
+
+		reset();
+		return nullptr;
+	}
+
+	void* get_val_impl(std::true_type) noexcept
+	{
+		return buffer();
+	}
+
+	void* get_val_impl(std::false_type) noexcept
+	{
+		return *static_cast<void**>(buffer());
+	}
+
+	// The allocator is a base so the stateless ones take no space. Swapping the storage swaps the allocators too.
+	// The handler follows the buffer directly so a 56 byte buffer aligned to 64 makes a 64 byte any.
+	struct storage : Alloc
+	{
+		constexpr storage() noexcept
+			:Alloc{},
+			buffer{},
+			handler{}
+		{
+		}
+
+		ANY_CONSTEXPR storage(const Alloc& alloc) noexcept
+			:Alloc{ alloc },
+			handler{}
+		{
+		}
+
+		// not std::aligned_storage_t, it isn't required to honour alignments above alignof(std::max_align_t)
+		alignas(Align) unsigned char buffer[Capacity];
+		const Handler* handler;
+	};
+
+	storage _storage;
+};
+
+template<size_t Capacity, size_t Align, class Alloc = any_pool_allocator, bool RelocatableOnly = false, class... Ops>
+class basic_any;
+
+struct any_batch;
+
+template<class T>
+struct is_basic_any : std::false_type {};
+
+template<size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly, class... Ops>
+struct is_basic_any<basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>> : std::true_type {};
+
+// Only when nothing but relocatable types can end up in the buffer.
+template<size_t Capacity, size_t Align, class Alloc, class... Ops>
+struct is_trivially_relocatable<basic_any<Capacity, Align, Alloc, true, Ops...>> : is_trivially_relocatable<Alloc> {};
+
+// Values only convert between anys with the same operations, their tables are different types otherwise.
+template<size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly, class... Ops>
+class basic_any : public any_storage<basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>, any_handler, Capacity, Align, Alloc, RelocatableOnly>
+{
+	using base = any_storage<basic_any, any_handler, Capacity, Align, Alloc, RelocatableOnly>;
+
+	friend base;
+
+	template<size_t, size_t, class, bool, class...>
+	friend class basic_any;
+
+	friend struct any_batch;
+
+	template<class T>
+	using handlers = any_handlers<T, Alloc, Ops...>;
+
+	using base::_storage;
+	using base::allocator;
+	using base::buffer;
+	using base::equal;
+	using base::move_from;
+	using base::relocate;
+
+public:
+	using base::hash;
+
+	constexpr basic_any() noexcept
+		:base{}
+	{
+	}
+
+	basic_any(std::allocator_arg_t, const Alloc& alloc) noexcept
+		:base{ alloc }
+	{
+	}
+
+	ANY_CONSTEXPR basic_any(const basic_any& other)
+		:base{ other.get_allocator() }
+	{
+#if ANY_HAS_CONSTEXPR
+		if (std::is_constant_evaluated())
+		{
+			constant_copy(other);
+			return;
+		}
+#endif
+		copy_from(other);
+	}
+
+	basic_any(std::allocator_arg_t, const Alloc& alloc, const basic_any& other)
+		:base{ alloc }
+	{
+		copy_from(other);
+	}
+
+	ANY_CONSTEXPR basic_any(basic_any&& other) noexcept
+		:base{ other.get_allocator() }
+	{
+#if ANY_HAS_CONSTEXPR
+		if (std::is_constant_evaluated())
+		{
+			constant_copy(other);
+			other._storage.handler = nullptr;
+			return;
+		}
+#endif
+		relocate(_storage, other._storage);
+	}
+
+	// Only allocates when the allocators differ and the value is big.
+	basic_any(std::allocator_arg_t, const Alloc& alloc, basic_any&& other)
+		:base{ alloc }
+	{
+		move_from(other);
+	}
+
+	template<size_t OtherCapacity, size_t OtherAlign, bool OtherRelocatableOnly>
+	basic_any(const basic_any<OtherCapacity, OtherAlign, Alloc, OtherRelocatableOnly, Ops...>& other)
+		:base{ other.get_allocator() }
+	{
+		copy_from(other);
+	}
+
+	// Doesn't allocate unless the value is small in <other> but doesn't fit inside our buffer.
+	template<size_t OtherCapacity, size_t OtherAlign, bool OtherRelocatableOnly>
+	basic_any(basic_any<OtherCapacity, OtherAlign, Alloc, OtherRelocatableOnly, Ops...>&& other)
+		:base{ other.get_allocator() }
+	{
+		move_from(other);
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_any<VT>::value // can use conjunction and negation for short circuit but it's too hard to read
+										   && std::is_copy_constructible_v<VT>>> // check if VT is a specialization of in_place_type_t
+	ANY_CONSTEXPR basic_any(T&& value)
+		:base{ Alloc{} }
+	{
+#if ANY_HAS_CONSTEXPR
+		if constexpr (is_constant<VT>::value)
+		{
+			if (std::is_constant_evaluated())
+			{
+				constant_emplace<VT>(value);
+				return;
+			}
+		}
+#endif
+		emplace<VT>(std::forward<T>(value));
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_any<VT>::value
+										   && std::is_copy_constructible_v<VT>>>
+	basic_any(std::allocator_arg_t, const Alloc& alloc, T&& value)
+		:base{ alloc }
+	{
+		emplace<VT>(std::forward<T>(value));
+	}
+
+	template<class T, class... Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+											       && std::is_constructible_v<VT, Args...>>>
+	explicit ANY_CONSTEXPR basic_any(std::in_place_type_t<T>, Args&&... args)
+		:base{ Alloc{} }
+	{
+#if ANY_HAS_CONSTEXPR
+		if constexpr (is_constant<VT>::value)
+		{
+			if (std::is_constant_evaluated())
+			{
+				constant_emplace<VT>(VT(std::forward<Args>(args)...));
+				return;
+			}
+		}
+#endif
+		emplace<VT>(std::forward<Args>(args)...);
+	}
+
+	template<class T, class... Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+											       && std::is_constructible_v<VT, Args...>>>
+	explicit basic_any(std::allocator_arg_t, const Alloc& alloc, std::in_place_type_t<T>, Args&&... args)
+		:base{ alloc }
+	{
+		emplace<VT>(std::forward<Args>(args)...);
+	}
+
+	template<class T, class U, class...Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+													 && std::is_constructible_v<VT, std::initializer_list<U>&, Args...>>>
+	explicit basic_any(std::in_place_type_t<T>, std::initializer_list<U> il, Args&&... args)
+		:base{ Alloc{} }
+	{
+		emplace<VT>(il, std::forward<Args>(args)...);
+	}
+
+	ANY_CONSTEXPR ~basic_any()
+	{
+#if ANY_HAS_CONSTEXPR
+		if (std::is_constant_evaluated())
+		{
+			_storage.handler = nullptr; // only trivially copyable values get here, there's nothing to destroy
+			return;
+		}
+#endif
+		this->reset();
+	}
+
+	basic_any& operator=(const basic_any& rhs)
+	{
+		basic_any(std::allocator_arg, this->get_allocator(), rhs).swap(*this);
+
+		return *this;
+	}
+
+	basic_any& operator=(basic_any&& rhs) noexcept(Alloc::is_always_equal::value)
+	{
+		basic_any(std::allocator_arg, this->get_allocator(), std::move(rhs)).swap(*this);
+		return *this;
+	}
+
+	// Assigns in place when we hold a VT already, so the value keeps its storage (and, for VT, whatever it owns).
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_any<VT>::value
+										   && std::is_copy_constructible_v<VT>>>
+	basic_any& operator=(T&& rhs)
+	{
+		if constexpr (std::is_assignable_v<VT&, T>)
+		{
+			if (this->type_id() == any_type_id_of<VT>())
+			{
+				*this->template get_val<VT>() = std::forward<T>(rhs);
+				return *this;
+			}
+		}
+
+		basic_any tmp(std::allocator_arg, this->get_allocator(), std::forward<T>(rhs));
+
+		tmp.swap(*this);
+
+		return *this;
+	}
+
+	// Emplacing a VT over a VT assigns it in place. A big value replacing another one reuses its heap block when it can.
+	template<class T, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+												 && std::is_constructible_v<VT, Args...>>>
+	std::decay_t<T>& emplace(Args&&... args)
+	{
+		if constexpr (sizeof...(Args) == 1 && ((std::is_same_v<std::decay_t<Args>, VT> && std::is_assignable_v<VT&, Args>) && ...))
+		{
+			if (this->type_id() == any_type_id_of<VT>())
+			{
+				VT& value = *this->template get_val<VT>();
+				((value = std::forward<Args>(args)), ...);
+				return value;
+			}
+		}
+
+		return this->template emplace_impl<VT>(std::forward<Args>(args)...);
+	}
+
+	template<class T, class U, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+													  && std::is_constructible_v<VT,std::initializer_list<U>&, Args...>>>
+	std::decay_t<T>& emplace(std::initializer_list<U> il, Args&&... args)
+	{
+		return this->template emplace_impl<VT>(il, std::forward<Args>(args)...);
+	}
+
+	// Equal when both are empty, or hold values of the same type that compare equal. Throws bad_any_operation if the
+	// type isn't any_is_equality_comparable.
+	friend bool operator==(const basic_any& lhs, const basic_any& rhs)
+	{
+		return equal(lhs, rhs);
+	}
+
+	friend bool operator!=(const basic_any& lhs, const basic_any& rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+	// Calls one of our Ops on the value. Throws bad_any_operation without one.
+	template<class Op, class... Args>
+	decltype(auto) call(Args&&... args)
+	{
+		return call_impl<Op>(buffer(), std::forward<Args>(args)...);
+	}
+
+	template<class Op, class... Args>
+	decltype(auto) call(Args&&... args) const
+	{
+		static_assert(Op::is_const, "Op takes the value by non-const reference");
+		return call_impl<Op>(buffer(), std::forward<Args>(args)...);
+	}
+
+#if ANY_HAS_CONSTEXPR
+	// What any_cast<T> by value uses in constant evaluation, where the value can only be rebuilt from the buffer's bytes.
+	template<class T>
+	constexpr T get_constant_val() const
+	{
+		static_assert(is_constant<T>::value, "only small trivially copyable values exist in constant evaluation");
+
+		if (this->type_id() != any_type_id_of<T>())
+		{
+			throw bad_any_cast({});
+		}
+
+		constant_bytes<T> bytes{};
+		for (size_t i = 0; i < sizeof(T); ++i)
+		{
+			bytes.data[i] = _storage.buffer[i];
+		}
+		return std::bit_cast<T>(bytes);
+	}
+#endif
+
+private:
+#if ANY_HAS_CONSTEXPR
+	template<class T>
+	using is_constant = std::bool_constant<any_is_small<T, Capacity, Align, RelocatableOnly>::value && std::is_trivially_copyable_v<T>>;
+
+	template<class T>
+	struct constant_bytes
+	{
+		unsigned char data[sizeof(T)];
+	};
+
+	// The whole buffer is written, a constant can't have indeterminate bytes.
+	template<class T>
+	constexpr void constant_emplace(const T& value) noexcept
+	{
+		const auto bytes = std::bit_cast<constant_bytes<T>>(value);
+		for (size_t i = 0; i < Capacity; ++i)
+		{
+			_storage.buffer[i] = i < sizeof(T) ? bytes.data[i] : 0;
+		}
+		_storage.handler = &any_handlers<T, Alloc, Ops...>::small;
+	}
+
+	constexpr void constant_copy(const basic_any& other) noexcept
+	{
+		for (size_t i = 0; i < Capacity; ++i)
+		{
+			_storage.buffer[i] = other._storage.buffer[i];
+		}
+		_storage.handler = other._storage.handler;
+	}
+#endif
+
+	template<class Op, class Buffer, class... Args>
+	decltype(auto) call_impl(Buffer* storage, Args&&... args) const
+	{
+		static_assert((std::is_same_v<Op, Ops> || ...), "Op isn't one of the operations of this any");
+
+		const auto* handler = static_cast<const any_ops_handler<Ops...>*>(_storage.handler);
+
+		if (!handler)
+		{
+			throw bad_any_operation{};
+		}
+
+		return handler->template get<Op>()(handler->object(storage), std::forward<Args>(args)...);
+	}
+
+	template<size_t OtherCapacity, size_t OtherAlign, bool OtherRelocatableOnly>
+	void copy_from(const basic_any<OtherCapacity, OtherAlign, Alloc, OtherRelocatableOnly, Ops...>& other)
+	{
+		const any_handler* handler = other._storage.handler;
+
+		if (!handler)
+		{
+			return;
+		}
+
+		if constexpr (OtherCapacity == Capacity && OtherAlign == Align && OtherRelocatableOnly == RelocatableOnly)
+		{
+			handler->_copy(buffer(), other.buffer(), &allocator());
+		}
+		else
+		{
+			// the value may change representation, big operations take a pointer to the object
+			const void* object = handler->object(other.buffer());
+			handler = handler->fits(Capacity, Align, RelocatableOnly) ? handler->_small : handler->_big;
+			handler->_copy(buffer(), handler->_representation == any_representation::Big ? &object : object, &allocator());
+		}
+
+		_storage.handler = handler;
+	}
+};
+
+using any = basic_any<small_space_size, small_space_align>;
+
+// Opt-in for over-aligned types (SIMD vectors, cache line aligned structs) so they're stored inline instead of on the heap.
+// Note that the any itself becomes Align aligned, which grows it and its containers.
+template<size_t Align, size_t Capacity = small_space_size>
+using aligned_any = basic_any<Capacity, Align>;
+
+// Exactly one cache line, buffer and handler included, and aligned to one: scanning an array of them touches one line
+// per element where an array of any (72 bytes on 64 bit) straddles two lines every other element. The buffer shrinks
+// to 56 bytes. Only with a stateless allocator, a stateful one would take the room of the handler.
+constexpr size_t any_cache_line_size = 64;
+
+using cache_line_any = basic_any<any_cache_line_size - sizeof(void*), any_cache_line_size>;
+
+static_assert(sizeof(cache_line_any) == any_cache_line_size, "the handler pointer follows the buffer with no padding");
+
+// Non relocatable types (self referential ones, e.g. libstdc++'s std::string and std::list) go on the heap,
+// so containers can move relocatable_any around as raw bytes.
+using relocatable_any = basic_any<small_space_size, small_space_align, any_pool_allocator, true>;
+
+// An any that can call the listed operations on its value (see any_operation).
+template<class... Ops>
+using any_with = basic_any<small_space_size, small_space_align, any_pool_allocator, false, Ops...>;
+
+namespace pmr
+{
+	// Big values live in the memory_resource the any was constructed with, e.g. a request scoped monotonic_buffer_resource.
+	template<size_t Capacity, size_t Align>
+	using basic_any = ::basic_any<Capacity, Align, any_resource_allocator>;
+
+	using any = basic_any<small_space_size, small_space_align>;
+}
+
+template<size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly, class... Ops>
+inline void swap(basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>& x, basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>& y) noexcept
+{
+	x.swap(y);
+}
+
+// Hashes the value like std::hash<T> would, so a T and an any holding it land in the same bucket.
+template<size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly, class... Ops>
+struct std::hash<basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>>
+{
+	size_t operator()(const basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>& value) const
+	{
+		return value.hash();
+	}
+};
+
+template<class T, class... Args>
+any make_any(Args&&... args)
+{
+	return any{std::in_place_type<T>, std::forward<Args>(args)...};
+}
+
+template<class T, class U, class... Args>
+any make_any(std::initializer_list<U> il, Args&&... args)
+{
+	return any{std::in_place_type<T>, il, std::forward<Args>(args)...};
+}
+
+// Whether reading a T out of an Any can't throw, it can for the non-const get_val of basic_shared_any.
+template<class T, class Any>
+constexpr bool is_nothrow_get_val_v = noexcept(std::declval<Any&>().template get_val<T>());
+
+/*
+	The bodies of the any_cast overloads of every any with type_id() and get_val<T>(). Each any declares the overloads
+	for its own type, so the right one is picked for it, and forwards here: the checks, the stats and the cv handling
+	are written once.
+*/
+struct any_cast_impl
+{
+	// any_cast<T>(&operand), a const T* for a const Any.
+	template<class T, class Any>
+	static auto pointer(Any* operand) noexcept(is_nothrow_get_val_v<T, Any>) -> decltype(operand->template get_val<T>())
+	{
+		if (operand != nullptr && operand->type_id() == any_type_id_of<T>())
+		{
+			return operand->template get_val<T>();
+		}
+
+		ANY_STATS_COUNT_TYPE(T, failed_casts, 1);
+		return nullptr;
+	}
+
+	// any_cast<T>(operand). Any is an lvalue reference for an lvalue operand, which T is built from as the T& or const T&
+	// its pointer cast gives, and not a reference for an rvalue, which T is moved from.
+	template<class T, class Any>
+	static ANY_CONSTEXPR T value(Any&& operand); // after the any_cast overloads below, which it calls
+};
+
+// The casts of basic_any, basic_unique_any and basic_shared_any, they find the any_storage of the operand.
+template<class T, class Derived, class Handler, size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly>
+ANY_CONSTEXPR T any_cast(const any_storage<Derived, Handler, Capacity, Align, Alloc, RelocatableOnly>& operand)
+{
+#if ANY_HAS_CONSTEXPR
+	if constexpr (is_basic_any<Derived>::value && !std::is_reference_v<T> && std::is_trivially_copyable_v<std::remove_cv_t<T>>
+				  && any_is_small<std::remove_cv_t<T>, Capacity, Align, RelocatableOnly>::value)
+	{
+		if (std::is_constant_evaluated())
+		{
+			return static_cast<const Derived&>(operand).template get_constant_val<std::remove_cv_t<T>>();
+		}
+	}
+#endif
+
+	return any_cast_impl::value<T>(static_cast<const Derived&>(operand));
+}
+
+template<class T, class Derived, class Handler, size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly>
+ANY_CONSTEXPR T any_cast(any_storage<Derived, Handler, Capacity, Align, Alloc, RelocatableOnly>& operand)
+{
+#if ANY_HAS_CONSTEXPR
+	if constexpr (is_basic_any<Derived>::value && !std::is_reference_v<T> && std::is_trivially_copyable_v<std::remove_cv_t<T>>
+				  && any_is_small<std::remove_cv_t<T>, Capacity, Align, RelocatableOnly>::value)
+	{
+		if (std::is_constant_evaluated())
+		{
+			return static_cast<const Derived&>(operand).template get_constant_val<std::remove_cv_t<T>>();
+		}
+	}
+#endif
+
+	return any_cast_impl::value<T>(static_cast<Derived&>(operand));
+}
+
+template<class T, class Derived, class Handler, size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly>
+ANY_CONSTEXPR T any_cast(any_storage<Derived, Handler, Capacity, Align, Alloc, RelocatableOnly>&& operand)
+{
+#if ANY_HAS_CONSTEXPR
+	if constexpr (is_basic_any<Derived>::value && !std::is_reference_v<T> && std::is_trivially_copyable_v<std::remove_cv_t<T>>
+				  && any_is_small<std::remove_cv_t<T>, Capacity, Align, RelocatableOnly>::value)
+	{
+		if (std::is_constant_evaluated())
+		{
+			return static_cast<const Derived&>(operand).template get_constant_val<std::remove_cv_t<T>>();
+		}
+	}
+#endif
+
+	return any_cast_impl::value<T>(static_cast<Derived&&>(operand));
+}
+
+template<class T, class Derived, class Handler, size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly>
+const T* any_cast(const any_storage<Derived, Handler, Capacity, Align, Alloc, RelocatableOnly>* operand) noexcept
+{
+	return any_cast_impl::pointer<T>(static_cast<const Derived*>(operand));
+}
+
+// Only noexcept when the any's mutable get_val is, basic_shared_any's copies a shared value first.
+template<class T, class Derived, class Handler, size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly>
+T* any_cast(any_storage<Derived, Handler, Capacity, Align, Alloc, RelocatableOnly>* operand) noexcept(is_nothrow_get_val_v<T, Derived>)
+{
+	return any_cast_impl::pointer<T>(static_cast<Derived*>(operand));
+}
+
+template<class T, class Any>
+ANY_CONSTEXPR T any_cast_impl::value(Any&& operand)
+{
+	using U = std::remove_cv_t<std::remove_reference_t<T>>;
+	using reference = decltype(*any_cast<U>(&operand));
+	using source = std::conditional_t<std::is_lvalue_reference_v<Any>, reference, std::remove_reference_t<reference>&&>;
+	static_assert(std::is_constructible_v<T, source>);
+
+	const auto storagePtr = any_cast<U>(&operand);
+
+	if (!storagePtr)
+	{
+		throw bad_any_cast({});
+	}
+
+	return static_cast<T>(static_cast<source>(*storagePtr));
+}
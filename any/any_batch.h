@@ -0,0 +1,184 @@
+#pragma once
+/*
+	Batch operations over contiguous arrays of <basic_any>, for the std::vector<any> that holds thousands of values and
+	is cleared, copied or scanned as a whole.
+
+	Going through the anys one by one costs a has_value() test, an indirect _destroy/_copy call and, inside it, a branch
+	on the representation per element, even when every element holds the same type. Here the array is split into runs
+	of consecutive values sharing a handler (found by comparing the handler pointers, no call), and each run is handled
+	once: runs of small trivially copyable values aren't destroyed at all and are copied with a single memcpy, the other
+	runs call the one handler they share directly.
+
+		any_reset(first, last)         every any of [first, last) ends up empty
+		any_clear(vector)              any_reset then clear(), so the destructors only see empty anys
+		any_copy(first, last, out)     assigns [first, last) to the anys at <out>, like std::copy. The ranges must not
+		                               overlap, <out> is reset before [first, last) is read
+		any_copy(vector)               a copy of the vector
+		any_gather<T>(values, out)     copies every T of <values> to <out>, in order, for columnar processing
+
+	any_gather recognizes a T by the address of its handler table, a compare of the word next to the buffer, so the
+	loop has no call and no type_info in it.
+*/
+
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include "any.h"
+
+struct any_batch
+{
+	template<size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly, class... Ops>
+	static void reset(basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* first, basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* last) noexcept
+	{
+		while (first != last)
+		{
+			const any_handler* handler = first->_storage.handler;
+			auto* run = first;
+			while (first != last && first->_storage.handler == handler)
+			{
+				++first;
+			}
+
+			if (!handler)
+			{
+				continue;
+			}
+
+			if (!handler->_trivially_copyable)
+			{
+				for (auto* value = run; value != first; ++value)
+				{
+					handler->_destroy(value->buffer(), &value->allocator());
+				}
+			}
+
+			for (auto* value = run; value != first; ++value)
+			{
+				value->_storage.handler = nullptr;
+			}
+		}
+	}
+
+	template<size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly, class... Ops>
+	static void copy(const basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* first, const basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* last,
+		basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* out)
+	{
+		using any_type = basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>;
+
+		assert((!std::less<const any_type*>{}(out, last) || !std::less<const any_type*>{}(first, out + (last - first)))
+			   && "any_copy between overlapping ranges");
+		reset(out, out + (last - first));
+
+		while (first != last)
+		{
+			const any_handler* handler = first->_storage.handler;
+			const any_type* run = first;
+			while (first != last && first->_storage.handler == handler)
+			{
+				++first;
+			}
+
+			const size_t count = static_cast<size_t>(first - run);
+
+			if (!handler)
+			{
+				out += count;
+				continue;
+			}
+
+			if (handler->_trivially_copyable && std::is_empty_v<Alloc>)
+			{
+				// the anys are nothing but buffer and handler, so the whole run is one block
+				ANY_STATS_COUNT(handler->_stats, copies, count);
+				std::memcpy(static_cast<void*>(out), run, count * sizeof(any_type));
+				out += count;
+			}
+			else if (handler->_trivially_copyable)
+			{
+				ANY_STATS_COUNT(handler->_stats, copies, count);
+				for (; run != first; ++run, ++out)
+				{
+					std::memcpy(out->buffer(), run->buffer(), handler->_size);
+					out->_storage.handler = handler;
+				}
+			}
+			else
+			{
+				for (; run != first; ++run, ++out)
+				{
+					handler->_copy(out->buffer(), run->buffer(), &out->allocator());
+					out->_storage.handler = handler;
+				}
+			}
+		}
+	}
+
+	template<class T, size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly, class... Ops, class OutputIt>
+	static OutputIt gather(const basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* first, const basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* last, OutputIt out)
+	{
+		using any_type = basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>;
+
+		// a T is always stored the same way in a given basic_any, so only one of the two tables can show up
+		const any_handler* handler = any_type::template is_small<T>::value ? static_cast<const any_handler*>(&any_handlers<T, Alloc, Ops...>::small)
+																		  : static_cast<const any_handler*>(&any_handlers<T, Alloc, Ops...>::big);
+
+		for (; first != last; ++first)
+		{
+			if (first->_storage.handler == handler)
+			{
+				*out = *first->template get_val<T>();
+				++out;
+			}
+		}
+		return out;
+	}
+};
+
+template<size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly, class... Ops>
+void any_reset(basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* first, basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* last) noexcept
+{
+	any_batch::reset(first, last);
+}
+
+template<size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly, class... Ops, class VectorAlloc>
+void any_clear(std::vector<basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>, VectorAlloc>& values) noexcept
+{
+	any_batch::reset(values.data(), values.data() + values.size());
+	values.clear();
+}
+
+// Assigns like std::copy, the anys at <out> keep their allocators. Returns the end of the copied range.
+// [first, last) and the output range must not overlap.
+template<size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly, class... Ops>
+basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* any_copy(const basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* first,
+	const basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* last, basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>* out)
+{
+	any_batch::copy(first, last, out);
+	return out + (last - first);
+}
+
+template<size_t Capacity, size_t Align, class Alloc, bool RelocatableOnly, class... Ops, class VectorAlloc>
+std::vector<basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>, VectorAlloc> any_copy(const std::vector<basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>, VectorAlloc>& values)
+{
+	if constexpr (!std::is_empty_v<Alloc>)
+	{
+		return values; // every copy takes the allocator of its source, which empty anys can't be given
+	}
+	else
+	{
+		std::vector<basic_any<Capacity, Align, Alloc, RelocatableOnly, Ops...>, VectorAlloc> result(values.size(), values.get_allocator());
+		any_batch::copy(values.data(), values.data() + values.size(), result.data());
+		return result;
+	}
+}
+
+// <values> is any contiguous range of basic_any (std::vector, std::array, a C array).
+template<class T, class Range, class OutputIt>
+OutputIt any_gather(const Range& values, OutputIt out)
+{
+	const auto* first = std::data(values);
+	return any_batch::gather<T>(first, first + std::size(values), out);
+}
@@ -0,0 +1,443 @@
+#pragma once
+/*
+	<any_buffer> is an append-only sequence of values of any type, packed back to back: every value takes a handler
+	pointer plus its own size and alignment padding, not a whole small_space_size buffer like an <any> does.
+	A stream of 4 and 40 byte events takes 16 and 48 bytes per entry instead of 72 each.
+
+	The values live in chunks of at least chunk_size bytes and never move once appended, so references stay valid until
+	clear(). Each entry is laid out as
+		[const any_handler*][padding][value]
+	with the handler pointer aligned to alignof(void*) and the value to its own alignment (up to max_align), all offsets
+	relative to the start of the chunk. Iterating yields any_views: the handler and the object, castable like an any.
+
+	The headers are any_handlers<T, Alloc>::small, whose operations work on the objects directly. Chunks that only
+	hold trivially copyable values are copied with one memcpy and destroyed without looking at the entries.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "any.h"
+
+// A non owning reference to a value stored somewhere else, what iterating an any_buffer yields.
+template<class Void>
+class basic_any_view
+{
+public:
+	basic_any_view() noexcept = default;
+
+	basic_any_view(const any_handler* handler, Void* object) noexcept
+		:_handler{ handler },
+		_object{ object }
+	{
+	}
+
+	// any_view converts to const_any_view
+	template<class OtherVoid, typename = std::enable_if_t<std::is_convertible_v<OtherVoid*, Void*>>>
+	basic_any_view(const basic_any_view<OtherVoid>& other) noexcept
+		:_handler{ other.handler() },
+		_object{ other.object() }
+	{
+	}
+
+	bool has_value() const noexcept
+	{
+		return _handler != nullptr;
+	}
+
+	any_type_id type_id() const noexcept
+	{
+		return has_value() ? _handler->_id : any_type_id_of<void>();
+	}
+
+#if ANY_HAS_RTTI
+	const std::type_info& type() const noexcept
+	{
+		return has_value() ? _handler->_type() : typeid(void);
+	}
+#endif
+
+	const any_handler* handler() const noexcept
+	{
+		return _handler;
+	}
+
+	Void* object() const noexcept
+	{
+		return _object;
+	}
+
+private:
+	const any_handler* _handler = nullptr;
+	Void* _object = nullptr;
+};
+
+using any_view = basic_any_view<void>;
+using const_any_view = basic_any_view<const void>;
+
+template<class T, class Void>
+auto any_cast(const basic_any_view<Void>* operand) noexcept
+{
+	using result = std::conditional_t<std::is_const_v<Void>, const T*, T*>;
+
+	if (operand != nullptr && operand->type_id() == any_type_id_of<T>())
+	{
+		return static_cast<result>(operand->object());
+	}
+
+	ANY_STATS_COUNT_TYPE(T, failed_casts, 1);
+	return static_cast<result>(nullptr);
+}
+
+template<class T, class Void>
+T any_cast(const basic_any_view<Void>& operand)
+{
+	using U = std::remove_cv_t<std::remove_reference_t<T>>;
+
+	const auto storagePtr = any_cast<U>(&operand);
+
+	if (!storagePtr)
+	{
+		throw bad_any_cast({});
+	}
+
+	return static_cast<T>(*storagePtr);
+}
+
+template<class Alloc = any_pool_allocator>
+class basic_any_buffer
+{
+	struct chunk;
+
+public:
+	using allocator_type = Alloc;
+
+	static constexpr size_t chunk_size = 4096;
+	static constexpr size_t max_align = 64; // chunks are allocated with this alignment, so offsets survive copies
+
+	template<class Chunk, class View>
+	class basic_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = View;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = View;
+
+		basic_iterator() noexcept = default;
+
+		basic_iterator(Chunk* chunk, Chunk* last, size_t offset) noexcept
+			:_chunk{ chunk },
+			_last{ last },
+			_offset{ offset }
+		{
+			skip_empty();
+		}
+
+		View operator*() const noexcept
+		{
+			const any_handler* handler = header(_chunk->data, _offset);
+			return { handler, _chunk->data + value_offset(_offset, handler) };
+		}
+
+		basic_iterator& operator++() noexcept
+		{
+			_offset = next_offset(_offset, header(_chunk->data, _offset));
+			skip_empty();
+			return *this;
+		}
+
+		basic_iterator operator++(int) noexcept
+		{
+			basic_iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+
+		bool operator==(const basic_iterator& rhs) const noexcept
+		{
+			return _chunk == rhs._chunk && _offset == rhs._offset;
+		}
+
+		bool operator!=(const basic_iterator& rhs) const noexcept
+		{
+			return !(*this == rhs);
+		}
+
+	private:
+		void skip_empty() noexcept
+		{
+			while (_chunk != _last && _offset == _chunk->used)
+			{
+				++_chunk;
+				_offset = 0;
+			}
+		}
+
+		Chunk* _chunk = nullptr;
+		Chunk* _last = nullptr;
+		size_t _offset = 0;
+	};
+
+	using iterator = basic_iterator<chunk, any_view>;
+	using const_iterator = basic_iterator<const chunk, const_any_view>;
+
+	basic_any_buffer() = default;
+
+	explicit basic_any_buffer(const Alloc& alloc)
+		:_alloc{ alloc }
+	{
+	}
+
+	basic_any_buffer(const basic_any_buffer& other)
+		:_alloc{ other._alloc },
+		_count{ other._count },
+		_current{ other._current }
+	{
+		_chunks.reserve(other._chunks.size());
+
+		try
+		{
+			for (const chunk& c : other._chunks)
+			{
+				chunk& copy = _chunks.emplace_back(chunk{ static_cast<unsigned char*>(_alloc.allocate(c.capacity, max_align)), c.capacity });
+				copy.trivial = c.trivial;
+				copy_entries(copy, c);
+			}
+		}
+		catch (...)
+		{
+			release();
+			throw;
+		}
+	}
+
+	basic_any_buffer(basic_any_buffer&& other) noexcept
+		:_chunks{ std::move(other._chunks) },
+		_alloc{ other._alloc },
+		_count{ std::exchange(other._count, 0) },
+		_current{ std::exchange(other._current, 0) }
+	{
+		other._chunks.clear();
+	}
+
+	~basic_any_buffer()
+	{
+		release();
+	}
+
+	basic_any_buffer& operator=(const basic_any_buffer& rhs)
+	{
+		basic_any_buffer(rhs).swap(*this);
+		return *this;
+	}
+
+	basic_any_buffer& operator=(basic_any_buffer&& rhs) noexcept
+	{
+		basic_any_buffer(std::move(rhs)).swap(*this);
+		return *this;
+	}
+
+	void swap(basic_any_buffer& rhs) noexcept
+	{
+		std::swap(_chunks, rhs._chunks);
+		std::swap(_alloc, rhs._alloc);
+		std::swap(_count, rhs._count);
+		std::swap(_current, rhs._current);
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_any<VT>::value
+										   && std::is_copy_constructible_v<VT>>>
+	VT& push_back(T&& value)
+	{
+		return emplace_back<VT>(std::forward<T>(value));
+	}
+
+	template<class T, class... Args, typename = std::enable_if_t<std::is_copy_constructible_v<T> && std::is_constructible_v<T, Args...>>>
+	T& emplace_back(Args&&... args)
+	{
+		static_assert(alignof(T) <= max_align, "any_buffer can't store types aligned stricter than max_align");
+
+		const any_handler* handler = &any_handlers<T, Alloc>::small;
+		chunk& c = chunk_for(handler);
+
+		const size_t offset = value_offset(c.used, handler);
+		T* value = ::new(c.data + offset) T(std::forward<Args>(args)...);
+
+		*reinterpret_cast<const any_handler**>(c.data + c.used) = handler;
+		c.used = next_offset(c.used, handler);
+		c.trivial = c.trivial && std::is_trivially_copyable_v<T>;
+		++_count;
+
+		return *value;
+	}
+
+	iterator begin() noexcept
+	{
+		return { _chunks.data(), _chunks.data() + _chunks.size(), 0 };
+	}
+
+	iterator end() noexcept
+	{
+		return { _chunks.data() + _chunks.size(), _chunks.data() + _chunks.size(), 0 };
+	}
+
+	const_iterator begin() const noexcept
+	{
+		return { _chunks.data(), _chunks.data() + _chunks.size(), 0 };
+	}
+
+	const_iterator end() const noexcept
+	{
+		return { _chunks.data() + _chunks.size(), _chunks.data() + _chunks.size(), 0 };
+	}
+
+	size_t size() const noexcept
+	{
+		return _count;
+	}
+
+	bool empty() const noexcept
+	{
+		return _count == 0;
+	}
+
+	// Bytes taken by the entries, headers and padding included.
+	size_t bytes_used() const noexcept
+	{
+		size_t bytes = 0;
+		for (const chunk& c : _chunks)
+		{
+			bytes += c.used;
+		}
+		return bytes;
+	}
+
+	// Destroys every value but keeps the chunks for the next round of appends.
+	void clear() noexcept
+	{
+		for (chunk& c : _chunks)
+		{
+			destroy_entries(c);
+			c.used = 0;
+			c.trivial = true;
+		}
+		_count = 0;
+		_current = 0;
+	}
+
+	Alloc get_allocator() const noexcept
+	{
+		return _alloc;
+	}
+
+private:
+	struct chunk
+	{
+		unsigned char* data;
+		size_t capacity;
+		size_t used = 0;
+		bool trivial = true; // only trivially copyable values, copied with memcpy and never destroyed one by one
+	};
+
+	static constexpr size_t align_up(size_t offset, size_t align) noexcept
+	{
+		return (offset + align - 1) & ~(align - 1);
+	}
+
+	static const any_handler* header(const unsigned char* data, size_t offset) noexcept
+	{
+		return *reinterpret_cast<const any_handler* const*>(data + offset);
+	}
+
+	static size_t value_offset(size_t offset, const any_handler* handler) noexcept
+	{
+		return align_up(offset + sizeof(const any_handler*), handler->_align);
+	}
+
+	static size_t next_offset(size_t offset, const any_handler* handler) noexcept
+	{
+		return align_up(value_offset(offset, handler) + handler->_size, alignof(const any_handler*));
+	}
+
+	// The first chunk from the current one with room for the entry, a new one if there's none.
+	chunk& chunk_for(const any_handler* handler)
+	{
+		for (; _current < _chunks.size(); ++_current)
+		{
+			chunk& c = _chunks[_current];
+			if (next_offset(c.used, handler) <= c.capacity)
+			{
+				return c;
+			}
+		}
+
+		const size_t capacity = std::max(chunk_size, next_offset(0, handler));
+		_chunks.reserve(_chunks.size() + 1);
+		chunk c{ static_cast<unsigned char*>(_alloc.allocate(capacity, max_align)), capacity };
+		return _chunks.emplace_back(c);
+	}
+
+	// <destination> has the same capacity as <source>, entries keep their offsets.
+	static void copy_entries(chunk& destination, const chunk& source)
+	{
+		if (source.trivial)
+		{
+			std::memcpy(destination.data, source.data, source.used);
+			destination.used = source.used;
+			return;
+		}
+
+		for (size_t offset = 0; offset < source.used; )
+		{
+			const any_handler* handler = header(source.data, offset);
+			const size_t value = value_offset(offset, handler);
+
+			handler->_copy(destination.data + value, source.data + value, nullptr);
+			*reinterpret_cast<const any_handler**>(destination.data + offset) = handler;
+
+			offset = next_offset(offset, handler);
+			destination.used = offset; // a throwing copy leaves only constructed entries behind
+		}
+	}
+
+	static void destroy_entries(chunk& c) noexcept
+	{
+		if (c.trivial)
+		{
+			return;
+		}
+
+		for (size_t offset = 0; offset < c.used; offset = next_offset(offset, header(c.data, offset)))
+		{
+			const any_handler* handler = header(c.data, offset);
+			handler->_destroy(c.data + value_offset(offset, handler), nullptr);
+		}
+	}
+
+	void release() noexcept
+	{
+		for (chunk& c : _chunks)
+		{
+			destroy_entries(c);
+			_alloc.deallocate(c.data, c.capacity, max_align);
+		}
+		_chunks.clear();
+	}
+
+	std::vector<chunk> _chunks;
+	Alloc _alloc;
+	size_t _count = 0;
+	size_t _current = 0; // chunks before this one are full
+};
+
+using any_buffer = basic_any_buffer<>;
+
+template<class Alloc>
+inline void swap(basic_any_buffer<Alloc>& x, basic_any_buffer<Alloc>& y) noexcept
+{
+	x.swap(y);
+}
@@ -0,0 +1,319 @@
+#pragma once
+/*
+	<any_collection> holds values of any type like a std::vector<any> would, but groups them by type: every type gets
+	its own segment, a contiguous array of the values themselves (no buffers, no pointers to heap blocks).
+
+	Iterating the values of one type is then a plain loop over a T* that the compiler can inline and vectorize, instead
+	of an indirect call and a possible cache miss per element. The order of insertion is only kept within a segment.
+
+	The segments don't know their type at compile time, so copying, growing and destroying them goes through the same
+	per-type handler tables as <any> (any_handlers<T, Alloc>::small, whose operations work on objects of T directly).
+	Segment memory comes from Alloc, same policy as basic_any.
+*/
+
+#include <vector>
+
+#include "any.h"
+
+template<class Alloc = any_pool_allocator>
+class basic_any_collection
+{
+public:
+	using allocator_type = Alloc;
+
+	// The values of one type, in insertion order.
+	template<class T>
+	class segment_view
+	{
+	public:
+		segment_view(T* first, size_t count) noexcept
+			:_first{ first },
+			_count{ count }
+		{
+		}
+
+		T* begin() const noexcept { return _first; }
+		T* end() const noexcept { return _first + _count; }
+		size_t size() const noexcept { return _count; }
+		bool empty() const noexcept { return _count == 0; }
+		T& operator[](size_t i) const noexcept { return _first[i]; }
+
+	private:
+		T* _first;
+		size_t _count;
+	};
+
+	basic_any_collection() = default;
+
+	explicit basic_any_collection(const Alloc& alloc)
+		:_alloc{ alloc }
+	{
+	}
+
+	basic_any_collection(const basic_any_collection& other)
+		:_alloc{ other._alloc }
+	{
+		_segments.reserve(other._segments.size());
+
+		try
+		{
+			for (const segment& s : other._segments)
+			{
+				segment& copy = _segments.emplace_back(segment{ s.handler });
+				copy.reserve(_alloc, s.size);
+
+				for (; copy.size < s.size; ++copy.size)
+				{
+					s.handler->_copy(copy.at(copy.size), s.at(copy.size), nullptr);
+				}
+			}
+		}
+		catch (...)
+		{
+			clear();
+			throw;
+		}
+	}
+
+	basic_any_collection(basic_any_collection&& other) noexcept
+		:_segments{ std::move(other._segments) },
+		_alloc{ other._alloc }
+	{
+		other._segments.clear();
+	}
+
+	~basic_any_collection()
+	{
+		clear();
+	}
+
+	basic_any_collection& operator=(const basic_any_collection& rhs)
+	{
+		basic_any_collection(rhs).swap(*this);
+		return *this;
+	}
+
+	basic_any_collection& operator=(basic_any_collection&& rhs) noexcept
+	{
+		basic_any_collection(std::move(rhs)).swap(*this);
+		return *this;
+	}
+
+	void swap(basic_any_collection& rhs) noexcept
+	{
+		std::swap(_segments, rhs._segments);
+		std::swap(_alloc, rhs._alloc);
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_any<VT>::value
+										   && std::is_copy_constructible_v<VT>>>
+	VT& insert(T&& value)
+	{
+		return emplace<VT>(std::forward<T>(value));
+	}
+
+	template<class T, class... Args, typename = std::enable_if_t<std::is_copy_constructible_v<T> && std::is_constructible_v<T, Args...>>>
+	T& emplace(Args&&... args)
+	{
+		segment& s = segment_of(&any_handlers<T, Alloc>::small);
+
+		if (s.size == s.capacity)
+		{
+			// construct first, args may refer to a value of the segment
+			T value(std::forward<Args>(args)...);
+			grow(s);
+			Construct<T>(s.at(s.size), std::move(value));
+		}
+		else
+		{
+			Construct<T>(s.at(s.size), std::forward<Args>(args)...);
+		}
+
+		return static_cast<T*>(s.data)[s.size++];
+	}
+
+	// Devirtualized iteration over the values of T.
+	template<class T>
+	segment_view<T> values() noexcept
+	{
+		const segment* s = find(any_type_id_of<T>());
+		return { s ? static_cast<T*>(s->data) : nullptr, s ? s->size : 0 };
+	}
+
+	template<class T>
+	segment_view<const T> values() const noexcept
+	{
+		const segment* s = find(any_type_id_of<T>());
+		return { s ? static_cast<const T*>(s->data) : nullptr, s ? s->size : 0 };
+	}
+
+	// Calls <f> on every value of the listed types, one tight loop per type.
+	template<class... Ts, class F>
+	void for_each(F&& f)
+	{
+		(for_each_of<Ts>(f), ...);
+	}
+
+	template<class T>
+	size_t size() const noexcept
+	{
+		const segment* s = find(any_type_id_of<T>());
+		return s ? s->size : 0;
+	}
+
+	size_t size() const noexcept
+	{
+		size_t count = 0;
+		for (const segment& s : _segments)
+		{
+			count += s.size;
+		}
+		return count;
+	}
+
+	bool empty() const noexcept
+	{
+		return size() == 0;
+	}
+
+	size_t segment_count() const noexcept
+	{
+		return _segments.size();
+	}
+
+	// Destroys every value and frees the segments.
+	void clear() noexcept
+	{
+		for (segment& s : _segments)
+		{
+			s.destroy(_alloc);
+		}
+		_segments.clear();
+	}
+
+	Alloc get_allocator() const noexcept
+	{
+		return _alloc;
+	}
+
+private:
+	struct segment
+	{
+		const any_handler* handler;
+		void* data = nullptr;
+		size_t size = 0;
+		size_t capacity = 0;
+
+		void* at(size_t i) const noexcept
+		{
+			return static_cast<unsigned char*>(data) + i * handler->_size;
+		}
+
+		void reserve(Alloc& alloc, size_t count)
+		{
+			data = count ? alloc.allocate(count * handler->_size, handler->_align) : nullptr;
+			capacity = count;
+		}
+
+		void destroy(Alloc& alloc) noexcept
+		{
+			for (size_t i = 0; i < size; ++i)
+			{
+				handler->_destroy(at(i), nullptr);
+			}
+
+			if (data)
+			{
+				alloc.deallocate(data, capacity * handler->_size, handler->_align);
+			}
+		}
+	};
+
+	// There are usually a handful of types, a linear search beats hashing.
+	const segment* find(any_type_id id) const noexcept
+	{
+		for (const segment& s : _segments)
+		{
+			if (s.handler->_id == id)
+			{
+				return &s;
+			}
+		}
+		return nullptr;
+	}
+
+	segment& segment_of(const any_handler* handler)
+	{
+		if (const segment* s = find(handler->_id))
+		{
+			return const_cast<segment&>(*s);
+		}
+
+		_segments.push_back(segment{ handler });
+		return _segments.back();
+	}
+
+	// Doubles the capacity. Moves the values when T can be moved without throwing (the handler has a small
+	// representation), copies them otherwise so a throwing copy leaves the segment untouched.
+	void grow(segment& s)
+	{
+		segment bigger{ s.handler };
+		bigger.reserve(_alloc, s.capacity ? 2 * s.capacity : 4);
+
+		if (s.handler->_big->_small)
+		{
+			for (size_t i = 0; i < s.size; ++i)
+			{
+				s.handler->_move(bigger.at(i), s.at(i));
+			}
+		}
+		else
+		{
+			try
+			{
+				for (; bigger.size < s.size; ++bigger.size)
+				{
+					s.handler->_copy(bigger.at(bigger.size), s.at(bigger.size), nullptr);
+				}
+			}
+			catch (...)
+			{
+				bigger.destroy(_alloc);
+				throw;
+			}
+
+			for (size_t i = 0; i < s.size; ++i)
+			{
+				s.handler->_destroy(s.at(i), nullptr);
+			}
+		}
+
+		if (s.data)
+		{
+			_alloc.deallocate(s.data, s.capacity * s.handler->_size, s.handler->_align);
+		}
+
+		s.data = bigger.data;
+		s.capacity = bigger.capacity;
+	}
+
+	template<class T, class F>
+	void for_each_of(F& f)
+	{
+		for (T& value : values<T>())
+		{
+			f(value);
+		}
+	}
+
+	std::vector<segment> _segments;
+	Alloc _alloc;
+};
+
+using any_collection = basic_any_collection<>;
+
+template<class Alloc>
+inline void swap(basic_any_collection<Alloc>& x, basic_any_collection<Alloc>& y) noexcept
+{
+	x.swap(y);
+}
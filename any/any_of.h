@@ -0,0 +1,437 @@
+#pragma once
+/*
+	<any_of<Ts...>> is an <any> that can only hold one of Ts..., for slots where the set of types is known.
+
+	Instead of a handler pointer it stores the index of the alternative in the smallest unsigned type that fits, and its
+	buffer is exactly as big and as aligned as the largest alternative, so nothing ever goes to the heap. Destroy, copy
+	and move switch on the index into code the compiler sees and can inline, and are skipped or become a memcpy when
+	every alternative allows it. any_cast compares the index against a constant instead of a type_id, and visit() jumps
+	straight through a table indexed by it, without the any_type_index lookup any_visit needs for an open any.
+
+	to_any() stores the value in an open basic_any with one emplace. An any_of constructed from a basic_any finds the
+	alternative through any_type_index (any_visit.h) and throws bad_any_cast when the any holds something else.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+
+#include "any.h"
+#include "any_visit.h"
+
+template<class... Ts>
+class any_of;
+
+template<class T>
+struct is_any_of : std::false_type {};
+
+template<class... Ts>
+struct is_any_of<any_of<Ts...>> : std::true_type {};
+
+template<class... Ts>
+class any_of
+{
+	static_assert(sizeof...(Ts) > 0, "any_of needs at least one alternative");
+	static_assert(((std::is_same_v<Ts, std::decay_t<Ts>> && !std::is_void_v<Ts>) && ...), "any_of alternatives must be object types without cv qualifiers");
+	static_assert((std::is_copy_constructible_v<Ts> && ...), "any_of alternatives must be copy constructible, like any's");
+
+	template<size_t I>
+	using alternative_t = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+	static constexpr bool trivially_destructible = (std::is_trivially_destructible_v<Ts> && ...);
+	static constexpr bool trivially_copyable = (std::is_trivially_copyable_v<Ts> && ...);
+	static constexpr bool trivially_relocatable = (is_trivially_relocatable_v<Ts> && ...);
+	static constexpr bool nothrow_move = (std::is_nothrow_move_constructible_v<Ts> && ...);
+
+public:
+	using index_type = std::conditional_t<(sizeof...(Ts) < UINT8_MAX), uint8_t, uint16_t>;
+
+	// The index of an empty any_of, and of a type that isn't one of Ts...
+	static constexpr size_t npos = sizeof...(Ts);
+
+	// The index of the first T in Ts..., a cv-qualified T finds its unqualified alternative (any_cast<const T>).
+	template<class T>
+	static constexpr size_t index_of() noexcept
+	{
+		constexpr bool matches[] = { std::is_same_v<std::remove_cv_t<T>, Ts>... };
+		for (size_t i = 0; i < sizeof...(Ts); ++i)
+		{
+			if (matches[i])
+			{
+				return i;
+			}
+		}
+		return npos;
+	}
+
+	template<class T>
+	using holds = std::bool_constant<index_of<T>() != npos>;
+
+	constexpr any_of() noexcept
+		:_buffer{},
+		_index{ npos }
+	{
+	}
+
+	any_of(const any_of& other)
+		:_index{ npos }
+	{
+		copy_from(other);
+	}
+
+	// The buffer is value-initialized, GCC can't tell which alternative move_from constructs and would warn about
+	// reading it when the any_of is moved on.
+	any_of(any_of&& other) noexcept(nothrow_move)
+		:_buffer{},
+		_index{ npos }
+	{
+		move_from(other);
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_any_of<VT>::value && holds<VT>::value>>
+	any_of(T&& value)
+		:_index{ npos }
+	{
+		emplace<VT>(std::forward<T>(value));
+	}
+
+	template<class T, class... Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<holds<VT>::value
+											       && std::is_constructible_v<VT, Args...>>>
+	explicit any_of(std::in_place_type_t<T>, Args&&... args)
+		:_index{ npos }
+	{
+		emplace<VT>(std::forward<Args>(args)...);
+	}
+
+	template<class T, class U, class...Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<holds<VT>::value
+													 && std::is_constructible_v<VT, std::initializer_list<U>&, Args...>>>
+	explicit any_of(std::in_place_type_t<T>, std::initializer_list<U> il, Args&&... args)
+		:_index{ npos }
+	{
+		emplace<VT>(il, std::forward<Args>(args)...);
+	}
+
+	// From an open any holding one of Ts..., or nothing. Throws bad_any_cast for any other type.
+	template<class Any, typename = std::enable_if_t<is_basic_any<std::decay_t<Any>>::value && !holds<std::decay_t<Any>>::value>>
+	explicit any_of(Any&& other)
+		:_index{ npos }
+	{
+		if (!other.has_value())
+		{
+			return;
+		}
+
+		const size_t index = any_type_index<Ts...>::find(other.type_id());
+		if (index == npos)
+		{
+			throw bad_any_cast{};
+		}
+
+		dispatch(index, [&](auto i)
+		{
+			using T = alternative_t<decltype(i)::value>;
+			if constexpr (std::is_lvalue_reference_v<Any>)
+			{
+				Construct<T>(_buffer, *other.template get_val<T>());
+			}
+			else
+			{
+				Construct<T>(_buffer, std::move(*other.template get_val<T>()));
+			}
+		});
+		_index = static_cast<index_type>(index);
+	}
+
+	~any_of()
+	{
+		reset();
+	}
+
+	any_of& operator=(const any_of& rhs)
+	{
+		if (this != &rhs)
+		{
+			any_of(rhs).swap(*this);
+		}
+		return *this;
+	}
+
+	any_of& operator=(any_of&& rhs) noexcept(nothrow_move)
+	{
+		if (this != &rhs)
+		{
+			reset();
+			move_from(rhs);
+		}
+		return *this;
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_any_of<VT>::value && holds<VT>::value>>
+	any_of& operator=(T&& rhs)
+	{
+		if constexpr (std::is_assignable_v<VT&, T>)
+		{
+			if (_index == index_of<VT>())
+			{
+				*get_val<VT>() = std::forward<T>(rhs);
+				return *this;
+			}
+		}
+
+		emplace<VT>(std::forward<T>(rhs));
+		return *this;
+	}
+
+	template<class T, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<holds<VT>::value
+												 && std::is_constructible_v<VT, Args...>>>
+	std::decay_t<T>& emplace(Args&&... args)
+	{
+		reset();
+		ANY_STATS_COUNT_TYPE(VT, small_emplaces, 1);
+		Construct<VT>(_buffer, std::forward<Args>(args)...);
+		_index = static_cast<index_type>(index_of<VT>());
+		return *get_val<VT>();
+	}
+
+	template<class T, class U, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<holds<VT>::value
+													  && std::is_constructible_v<VT, std::initializer_list<U>&, Args...>>>
+	std::decay_t<T>& emplace(std::initializer_list<U> il, Args&&... args)
+	{
+		reset();
+		ANY_STATS_COUNT_TYPE(VT, small_emplaces, 1);
+		Construct<VT>(_buffer, il, std::forward<Args>(args)...);
+		_index = static_cast<index_type>(index_of<VT>());
+		return *get_val<VT>();
+	}
+
+	void reset() noexcept
+	{
+		if constexpr (!trivially_destructible)
+		{
+			dispatch(_index, [this](auto i)
+			{
+				using T = alternative_t<decltype(i)::value>;
+				std::destroy_at(get_val<T>());
+			});
+		}
+		_index = npos;
+	}
+
+	void swap(any_of& rhs) noexcept(nothrow_move)
+	{
+		if constexpr (trivially_relocatable)
+		{
+			std::swap(_buffer, rhs._buffer);
+			std::swap(_index, rhs._index);
+		}
+		else
+		{
+			any_of tmp(std::move(rhs));
+			rhs = std::move(*this);
+			*this = std::move(tmp);
+		}
+	}
+
+	// Stores the value in an open any, moving it out when called on an rvalue.
+	template<class Any = ::any>
+	Any to_any() const&
+	{
+		static_assert(is_basic_any<Any>::value, "to_any converts to a basic_any");
+
+		Any result;
+		dispatch(_index, [&](auto i)
+		{
+			using T = alternative_t<decltype(i)::value>;
+			result.template emplace<T>(*get_val<T>());
+		});
+		return result;
+	}
+
+	template<class Any = ::any>
+	Any to_any() &&
+	{
+		static_assert(is_basic_any<Any>::value, "to_any converts to a basic_any");
+
+		Any result;
+		dispatch(_index, [&](auto i)
+		{
+			using T = alternative_t<decltype(i)::value>;
+			result.template emplace<T>(std::move(*get_val<T>()));
+		});
+		return result;
+	}
+
+	// Calls visitor(T&) for the stored T through a table indexed by index(), throws bad_any_cast when empty.
+	template<class Visitor>
+	decltype(auto) visit(Visitor&& visitor)
+	{
+		return visit_impl(visitor, *this);
+	}
+
+	template<class Visitor>
+	decltype(auto) visit(Visitor&& visitor) const
+	{
+		return visit_impl(visitor, *this);
+	}
+
+	bool has_value() const noexcept
+	{
+		return _index != npos;
+	}
+
+	// The index in Ts... of the stored type, npos when empty.
+	size_t index() const noexcept
+	{
+		return _index;
+	}
+
+	any_type_id type_id() const noexcept
+	{
+		static constexpr any_type_id ids[] = { any_type_id_of<Ts>()..., any_type_id_of<void>() };
+		return ids[_index];
+	}
+
+#if ANY_HAS_RTTI
+	const std::type_info& type() const noexcept
+	{
+		static constexpr const std::type_info* types[] = { &typeid(Ts)..., &typeid(void) };
+		return *types[_index];
+	}
+#endif
+
+	template<class T>
+	T* get_val() noexcept
+	{
+		return reinterpret_cast<T*>(_buffer);
+	}
+
+	template<class T>
+	const T* get_val() const noexcept
+	{
+		return reinterpret_cast<const T*>(_buffer);
+	}
+
+private:
+	// Calls f(std::integral_constant<size_t, I>) for I == index, nothing when index is npos. The chain of comparisons
+	// against constants is what compilers turn into a jump table.
+	template<class F>
+	static void dispatch(size_t index, F&& f)
+	{
+		dispatch(index, f, std::index_sequence_for<Ts...>{});
+	}
+
+	template<class F, size_t... Is>
+	static void dispatch(size_t index, F& f, std::index_sequence<Is...>)
+	{
+		(void)((index == Is ? (f(std::integral_constant<size_t, Is>{}), true) : false) || ...);
+	}
+
+	template<class Visitor, class Self>
+	static decltype(auto) visit_impl(Visitor& visitor, Self& self)
+	{
+		using result = any_visit_detail::result_t<Visitor, Self, Ts...>;
+		static_assert((std::is_same_v<result, std::invoke_result_t<Visitor&, any_visit_detail::value_t<Ts, Self>&>> && ...),
+			"every alternative must return the same type");
+
+		using fallback = any_visit_detail::throw_bad_any_cast<result>;
+		using function = result (*)(Visitor&, fallback&, Self&);
+		static constexpr function table[] = { &any_visit_detail::invoke<result, Ts, Visitor, fallback, Self>...,
+			&any_visit_detail::fallback<result, Visitor, fallback, Self> };
+
+		fallback empty;
+		return table[self._index](visitor, empty, self);
+	}
+
+	void copy_from(const any_of& other)
+	{
+		if constexpr (trivially_copyable)
+		{
+			std::memcpy(_buffer, other._buffer, sizeof(_buffer));
+		}
+		else
+		{
+			dispatch(other._index, [&](auto i)
+			{
+				using T = alternative_t<decltype(i)::value>;
+				ANY_STATS_COUNT_TYPE(T, copies, 1);
+				Construct<T>(_buffer, *other.template get_val<T>());
+			});
+		}
+		_index = other._index;
+	}
+
+	void move_from(any_of& other) noexcept(nothrow_move)
+	{
+		if constexpr (trivially_relocatable)
+		{
+			std::memcpy(_buffer, other._buffer, sizeof(_buffer));
+		}
+		else
+		{
+			dispatch(other._index, [&](auto i)
+			{
+				using T = alternative_t<decltype(i)::value>;
+				ANY_STATS_COUNT_TYPE(T, moves, 1);
+				Construct<T>(_buffer, std::move(*other.template get_val<T>()));
+				std::destroy_at(other.template get_val<T>());
+			});
+		}
+		_index = std::exchange(other._index, static_cast<index_type>(npos));
+	}
+
+	alignas(Ts...) unsigned char _buffer[std::max({ sizeof(Ts)... })];
+	index_type _index;
+};
+
+template<class... Ts>
+inline void swap(any_of<Ts...>& x, any_of<Ts...>& y) noexcept(noexcept(x.swap(y)))
+{
+	x.swap(y);
+}
+
+template<class T, class... Ts>
+T any_cast(const any_of<Ts...>& operand)
+{
+	return any_cast_impl::value<T>(operand);
+}
+
+template<class T, class... Ts>
+T any_cast(any_of<Ts...>& operand)
+{
+	return any_cast_impl::value<T>(operand);
+}
+
+template<class T, class... Ts>
+T any_cast(any_of<Ts...>&& operand)
+{
+	return any_cast_impl::value<T>(std::move(operand));
+}
+
+// The pointer casts compare the index instead of a type_id, so they don't go through any_cast_impl::pointer.
+template<class T, class... Ts>
+const T* any_cast(const any_of<Ts...>* operand) noexcept
+{
+	static_assert(any_of<Ts...>::template holds<T>::value, "T is not one of the any_of alternatives, the cast could never succeed");
+
+	if (operand != nullptr && operand->index() == any_of<Ts...>::template index_of<T>())
+	{
+		return operand->template get_val<T>();
+	}
+
+	ANY_STATS_COUNT_TYPE(T, failed_casts, 1);
+	return nullptr;
+}
+
+template<class T, class... Ts>
+T* any_cast(any_of<Ts...>* operand) noexcept
+{
+	static_assert(any_of<Ts...>::template holds<T>::value, "T is not one of the any_of alternatives, the cast could never succeed");
+
+	if (operand != nullptr && operand->index() == any_of<Ts...>::template index_of<T>())
+	{
+		return operand->template get_val<T>();
+	}
+
+	ANY_STATS_COUNT_TYPE(T, failed_casts, 1);
+	return nullptr;
+}
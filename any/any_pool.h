@@ -0,0 +1,177 @@
+#pragma once
+/*
+	Default allocator for the big representation of <any>.
+
+	Every thread keeps a free list per size class (multiples of 16 bytes, up to 512 bytes), so constructing and destroying
+	big values in a loop doesn't go back to the global heap and threads don't contend on it.
+
+	Blocks don't remember which thread allocated them. A block freed on another thread simply goes into that thread's
+	free list, which is safe because every block is an independent operator new allocation. Each list is capped so a
+	producer/consumer pair can't grow the consumer's cache without bound, anything over the cap goes back to the heap,
+	and so does everything a thread still has cached when it exits.
+
+	Sizes above 512 bytes and alignments above __STDCPP_DEFAULT_NEW_ALIGNMENT__ skip the pool.
+*/
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+class any_pool_allocator
+{
+public:
+	using is_always_equal = std::true_type;
+
+	static constexpr size_t granularity = 16;
+	static constexpr size_t max_pooled_size = 512;
+	static constexpr size_t max_cached_bytes = 64 * 1024; // per size class and thread
+
+	static constexpr bool is_pooled(size_t size, size_t align) noexcept
+	{
+		return size <= max_pooled_size && align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+	}
+
+	void* allocate(size_t size, size_t align)
+	{
+		if (!is_pooled(size, align))
+		{
+			return ::operator new(size, std::align_val_t{ align });
+		}
+
+		free_list& list = cache().lists[size_class(size)];
+
+		if (list.head)
+		{
+			free_block* block = list.head;
+			list.head = block->next;
+			--list.count;
+			return block;
+		}
+
+		return ::operator new(class_size(size));
+	}
+
+	void deallocate(void* block, size_t size, size_t align) noexcept
+	{
+		if (!is_pooled(size, align))
+		{
+			::operator delete(block, size, std::align_val_t{ align });
+			return;
+		}
+
+		thread_cache& c = cache();
+		free_list& list = c.lists[size_class(size)];
+
+		if (c.closed || (list.count + 1) * class_size(size) > max_cached_bytes)
+		{
+			::operator delete(block, class_size(size));
+			return;
+		}
+
+		if (!c.registered)
+		{
+			register_cleanup();
+			c.registered = true;
+		}
+
+		list.head = ::new(block) free_block{ list.head };
+		++list.count;
+	}
+
+	// Blocks of the same size class are the same allocation, so a big value can reuse the block of another one.
+	static constexpr bool interchangeable(size_t size, size_t align, size_t other_size, size_t other_align) noexcept
+	{
+		if (is_pooled(size, align) && is_pooled(other_size, other_align))
+		{
+			return size_class(size) == size_class(other_size);
+		}
+
+		return size == other_size && align == other_align;
+	}
+
+	bool operator==(const any_pool_allocator&) const noexcept
+	{
+		return true;
+	}
+
+	// Number of blocks of <size> bytes the calling thread has cached.
+	static size_t cached_blocks(size_t size) noexcept
+	{
+		return size && size <= max_pooled_size ? cache().lists[size_class(size)].count : 0;
+	}
+
+	// Gives every block the calling thread has cached back to the heap.
+	static void release_cached() noexcept
+	{
+		thread_cache& c = cache();
+
+		for (size_t i = 0; i < class_count; ++i)
+		{
+			free_list& list = c.lists[i];
+
+			while (list.head)
+			{
+				free_block* block = list.head;
+				list.head = block->next;
+				::operator delete(block, (i + 1) * granularity);
+			}
+			list.count = 0;
+		}
+	}
+
+private:
+	static constexpr size_t class_count = max_pooled_size / granularity;
+
+	static_assert(sizeof(void*) <= granularity, "a free block must be able to hold the next pointer");
+
+	struct free_block
+	{
+		free_block* next;
+	};
+
+	struct free_list
+	{
+		free_block* head;
+		size_t count;
+	};
+
+	// Trivially destructible so it's constant initialized and stays usable for the whole life of the thread,
+	// even from destructors that run after the cleanup below.
+	struct thread_cache
+	{
+		free_list lists[class_count];
+		bool registered;
+		bool closed;
+	};
+
+	struct thread_cache_cleanup
+	{
+		~thread_cache_cleanup()
+		{
+			release_cached();
+			cache().closed = true;
+		}
+	};
+
+	static constexpr size_t size_class(size_t size) noexcept
+	{
+		return size ? (size - 1) / granularity : 0;
+	}
+
+	static constexpr size_t class_size(size_t size) noexcept
+	{
+		return (size_class(size) + 1) * granularity;
+	}
+
+	static thread_cache& cache() noexcept
+	{
+		static thread_local thread_cache c{};
+		return c;
+	}
+
+	static void register_cleanup() noexcept
+	{
+		static thread_local thread_cache_cleanup cleanup;
+		(void)cleanup;
+	}
+};
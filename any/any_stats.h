@@ -0,0 +1,140 @@
+#pragma once
+/*
+	Placement statistics for <any>, compiled in with ANY_ENABLE_STATS=1 (it must be the same for every translation unit).
+
+	Every stored type gets one any_type_stats record counting its small and big emplaces, the bytes allocated for it,
+	copies, moves and failed any_casts to it. The counters are bumped by any_small/any_big and basic_any through the
+	handler tables, and any_stats::snapshot() reads every type that has been counted so far, e.g. to find out which
+	types spill to the heap and pick a better Capacity from real traffic.
+
+	With ANY_ENABLE_STATS=0 (the default) there are no records, the handlers have no _stats slot and ANY_STATS_COUNT
+	expands to nothing.
+*/
+
+#ifndef ANY_ENABLE_STATS
+#define ANY_ENABLE_STATS 0
+#endif
+
+#if ANY_ENABLE_STATS
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Constant initialized and only linked into the list of any_stats the first time it counts something.
+struct any_type_stats
+{
+	using counter = std::atomic<size_t> any_type_stats::*;
+
+	constexpr any_type_stats(const void* id, size_t size, size_t align, const char* (*name)() noexcept) noexcept
+		:id{ id },
+		size{ size },
+		align{ align },
+		name{ name }
+	{
+	}
+
+	any_type_stats(const any_type_stats&) = delete;
+	any_type_stats& operator=(const any_type_stats&) = delete;
+
+	void count(counter which, size_t n = 1) noexcept;
+
+	const void* id; // any_type_id
+	size_t size;
+	size_t align;
+	const char* (*name)() noexcept; // typeid(T).name() with RTTI, empty otherwise
+
+	std::atomic<size_t> small_emplaces{ 0 };
+	std::atomic<size_t> big_emplaces{ 0 };
+	std::atomic<size_t> bytes_allocated{ 0 };
+	std::atomic<size_t> copies{ 0 };
+	std::atomic<size_t> moves{ 0 };
+	std::atomic<size_t> failed_casts{ 0 };
+
+	std::atomic<bool> listed{ false };
+	any_type_stats* next{ nullptr };
+};
+
+// A plain copy of a record.
+struct any_type_counts
+{
+	const void* id;
+	const char* name;
+	size_t size;
+	size_t align;
+	size_t small_emplaces;
+	size_t big_emplaces;
+	size_t bytes_allocated;
+	size_t copies;
+	size_t moves;
+	size_t failed_casts;
+};
+
+class any_stats
+{
+public:
+	// Every type counted so far, most recently seen first.
+	static std::vector<any_type_counts> snapshot()
+	{
+		std::vector<any_type_counts> counts;
+
+		for (any_type_stats* s = head().load(std::memory_order_acquire); s; s = s->next)
+		{
+			counts.push_back({ s->id, s->name(), s->size, s->align,
+				s->small_emplaces.load(std::memory_order_relaxed), s->big_emplaces.load(std::memory_order_relaxed),
+				s->bytes_allocated.load(std::memory_order_relaxed), s->copies.load(std::memory_order_relaxed),
+				s->moves.load(std::memory_order_relaxed), s->failed_casts.load(std::memory_order_relaxed) });
+		}
+
+		return counts;
+	}
+
+	// Zeroes the counters, the types stay listed.
+	static void reset() noexcept
+	{
+		for (any_type_stats* s = head().load(std::memory_order_acquire); s; s = s->next)
+		{
+			for (any_type_stats::counter c : { &any_type_stats::small_emplaces, &any_type_stats::big_emplaces, &any_type_stats::bytes_allocated,
+											   &any_type_stats::copies, &any_type_stats::moves, &any_type_stats::failed_casts })
+			{
+				(s->*c).store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+
+private:
+	friend struct any_type_stats;
+
+	static std::atomic<any_type_stats*>& head() noexcept
+	{
+		static std::atomic<any_type_stats*> h{ nullptr };
+		return h;
+	}
+
+	static void enlist(any_type_stats& s) noexcept
+	{
+		any_type_stats* next = head().load(std::memory_order_relaxed);
+		do
+		{
+			s.next = next;
+		} while (!head().compare_exchange_weak(next, &s, std::memory_order_release, std::memory_order_relaxed));
+	}
+};
+
+inline void any_type_stats::count(counter which, size_t n) noexcept
+{
+	if (!listed.load(std::memory_order_relaxed) && !listed.exchange(true, std::memory_order_relaxed))
+	{
+		any_stats::enlist(*this);
+	}
+
+	(this->*which).fetch_add(n, std::memory_order_relaxed);
+}
+
+#define ANY_STATS_COUNT(stats, counter, n) (stats)->count(&any_type_stats::counter, (n))
+
+#else
+
+#define ANY_STATS_COUNT(stats, counter, n) ((void)0)
+
+#endif
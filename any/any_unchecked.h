@@ -0,0 +1,118 @@
+#pragma once
+/*
+	any_cast without the type check, for the inner loops where the type is already known.
+
+	any_cast(&a) compares the type_id of <a> against T's (a has_value() test, a load of the handler and a compare) and
+	counts failed casts, on every call. When the caller has already checked it once:
+
+		any_cast_unchecked<T>(a)       returns the T& that <a> holds. The type is only asserted, so in a release build it
+		                               compiles to the buffer address for a small T and to one load for a big one.
+		typed_any_ref<T>               checks once when it's made and keeps the T*, each access is then a plain pointer.
+
+	Holding anything but a T is undefined behaviour for any_cast_unchecked. A typed_any_ref is invalidated like an
+	iterator: by any change of the value of the any (assigning, emplacing, reset, swap, moving from it) and by moving
+	the any itself, since small values live inside it.
+
+	Both work for anything with type_id() and get_val<T>(): basic_any, basic_unique_any, basic_shared_any (where the
+	non-const forms unshare), basic_static_any and any_of. They are noexcept when the get_val<T>() they call is, so the
+	non-const forms on a basic_shared_any can throw what unsharing throws (bad_alloc, T's copy constructor).
+*/
+
+#include <cassert>
+
+#include "any.h"
+
+template<class T, class Any, typename = std::enable_if_t<!std::is_pointer_v<Any>>>
+T& any_cast_unchecked(Any& operand) noexcept(is_nothrow_get_val_v<T, Any>)
+{
+	assert(operand.type_id() == any_type_id_of<T>() && "any_cast_unchecked on an any that doesn't hold a T");
+	return *operand.template get_val<T>();
+}
+
+template<class T, class Any, typename = std::enable_if_t<!std::is_pointer_v<Any>>>
+const T& any_cast_unchecked(const Any& operand) noexcept
+{
+	assert(operand.type_id() == any_type_id_of<T>() && "any_cast_unchecked on an any that doesn't hold a T");
+	return *operand.template get_val<T>();
+}
+
+template<class T, class Any>
+T* any_cast_unchecked(Any* operand) noexcept(is_nothrow_get_val_v<T, Any>)
+{
+	return &any_cast_unchecked<T>(*operand);
+}
+
+template<class T, class Any>
+const T* any_cast_unchecked(const Any* operand) noexcept
+{
+	return &any_cast_unchecked<T>(*operand);
+}
+
+// The value of an any known to hold a T, checked once. typed_any_ref<const T> refers to the value of a const any.
+template<class T>
+class typed_any_ref
+{
+	using value_type = std::remove_const_t<T>;
+
+public:
+	// Throws bad_any_cast if <operand> doesn't hold a T.
+	template<class Any, typename = std::enable_if_t<!std::is_pointer_v<Any> && !std::is_same_v<std::remove_const_t<Any>, typed_any_ref>>>
+	explicit typed_any_ref(Any& operand)
+		:_value{ lookup(operand) }
+	{
+		if (!_value)
+		{
+			throw bad_any_cast{};
+		}
+	}
+
+	// Null if <operand> is null or doesn't hold a T, test it with operator bool.
+	template<class Any>
+	explicit typed_any_ref(Any* operand) noexcept(is_nothrow_get_val_v<value_type, Any>)
+		:_value{ operand ? lookup(*operand) : nullptr }
+	{
+	}
+
+	// typed_any_ref<T> converts to typed_any_ref<const T>.
+	template<class U, typename = std::enable_if_t<std::is_same_v<T, const U>>>
+	typed_any_ref(const typed_any_ref<U>& other) noexcept
+		:_value{ other.get() }
+	{
+	}
+
+	explicit operator bool() const noexcept
+	{
+		return _value != nullptr;
+	}
+
+	T* get() const noexcept
+	{
+		return _value;
+	}
+
+	T& operator*() const noexcept
+	{
+		return *_value;
+	}
+
+	T* operator->() const noexcept
+	{
+		return _value;
+	}
+
+private:
+	template<class Any>
+	static T* lookup(Any& operand) noexcept(is_nothrow_get_val_v<value_type, Any>)
+	{
+		static_assert(!std::is_const_v<Any> || std::is_const_v<T>, "a const any gives a typed_any_ref<const T>");
+
+		if (operand.type_id() != any_type_id_of<value_type>())
+		{
+			ANY_STATS_COUNT_TYPE(value_type, failed_casts, 1);
+			return nullptr;
+		}
+		return operand.template get_val<value_type>();
+	}
+
+	T* _value;
+};
@@ -0,0 +1,146 @@
+#pragma once
+/*
+	any_visit<Ts...>(visitor, a) calls visitor(any_cast<T&>(a)) for the T of Ts... that <a> holds, in constant time.
+
+	A chain of any_casts compares the type against every alternative in turn. Here the type_id is looked up once in a
+	small hash table built for Ts... (on first use, keyed by the any_type_id addresses), and the resulting index jumps
+	straight into a table of one function per alternative. The cost doesn't depend on the number of alternatives.
+
+	Values of any other type, and empty anys, go to the fallback: any_visit<Ts...>(visitor, a, fallback) calls
+	fallback(a), any_visit<Ts...>(visitor, a) throws bad_any_cast. Like std::visit, every call must return the same type.
+
+	Works for anything with type_id() and get_val<T>(): basic_any, basic_unique_any and basic_shared_any (where visiting
+	a non-const shared_any is mutable access, so it unshares).
+*/
+
+#include <array>
+#include <cstdint>
+#include <tuple>
+
+#include "any.h"
+
+// The index of a type_id in Ts..., sizeof...(Ts) when it isn't one of them.
+template<class... Ts>
+class any_type_index
+{
+public:
+	static constexpr size_t npos = sizeof...(Ts);
+
+	static size_t find(any_type_id id) noexcept
+	{
+		static const any_type_index table;
+		return table.lookup(id);
+	}
+
+private:
+	// A quarter full at most, so a lookup rarely probes more than one slot.
+	static constexpr size_t slot_bits = [] {
+		size_t bits = 2;
+		while ((size_t{ 1 } << bits) < 4 * sizeof...(Ts))
+		{
+			++bits;
+		}
+		return bits;
+	}();
+
+	static constexpr size_t slot_count = size_t{ 1 } << slot_bits;
+
+	struct slot
+	{
+		any_type_id id = nullptr;
+		size_t index = npos;
+	};
+
+	static size_t hash(any_type_id id) noexcept
+	{
+		// Fibonacci hashing, the high bits of the product are the well mixed ones
+		return static_cast<size_t>((static_cast<uint64_t>(reinterpret_cast<uintptr_t>(id)) * 0x9E3779B97F4A7C15ull) >> (64 - slot_bits));
+	}
+
+	any_type_index() noexcept
+	{
+		const any_type_id ids[] = { any_type_id_of<Ts>()... };
+
+		for (size_t i = 0; i < sizeof...(Ts); ++i)
+		{
+			size_t s = hash(ids[i]);
+			while (_slots[s].id && _slots[s].id != ids[i])
+			{
+				s = (s + 1) & (slot_count - 1);
+			}
+
+			if (!_slots[s].id) // a duplicate in Ts... keeps its first index
+			{
+				_slots[s] = { ids[i], i };
+			}
+		}
+	}
+
+	size_t lookup(any_type_id id) const noexcept
+	{
+		for (size_t s = hash(id); _slots[s].id; s = (s + 1) & (slot_count - 1))
+		{
+			if (_slots[s].id == id)
+			{
+				return _slots[s].index;
+			}
+		}
+		return npos;
+	}
+
+	std::array<slot, slot_count> _slots{};
+};
+
+namespace any_visit_detail
+{
+	template<class T, class Any>
+	using value_t = std::conditional_t<std::is_const_v<Any>, const T, T>;
+
+	template<class Visitor, class Any, class... Ts>
+	using result_t = std::invoke_result_t<Visitor&, value_t<std::tuple_element_t<0, std::tuple<Ts...>>, Any>&>;
+
+	template<class R, class T, class Visitor, class Fallback, class Any>
+	R invoke(Visitor& visitor, Fallback&, Any& operand)
+	{
+		return visitor(*operand.template get_val<T>()); // a const any returns a const T*
+	}
+
+	template<class R, class Visitor, class Fallback, class Any>
+	R fallback(Visitor&, Fallback& fallback, Any& operand)
+	{
+		return fallback(operand);
+	}
+
+	template<class R>
+	struct throw_bad_any_cast
+	{
+		template<class Any>
+		[[noreturn]] R operator()(Any&) const
+		{
+			throw bad_any_cast{};
+		}
+	};
+}
+
+template<class... Ts, class Visitor, class Any, class Fallback>
+decltype(auto) any_visit(Visitor&& visitor, Any& operand, Fallback&& fallback)
+{
+	static_assert(sizeof...(Ts) > 0, "any_visit needs at least one alternative");
+
+	using result = any_visit_detail::result_t<Visitor, Any, Ts...>;
+	static_assert((std::is_same_v<result, std::invoke_result_t<Visitor&, any_visit_detail::value_t<Ts, Any>&>> && ...),
+		"every alternative must return the same type");
+
+	using function = result (*)(Visitor&, Fallback&, Any&);
+	static constexpr function table[] = { &any_visit_detail::invoke<result, Ts, Visitor, Fallback, Any>...,
+		&any_visit_detail::fallback<result, Visitor, Fallback, Any> };
+
+	return table[any_type_index<Ts...>::find(operand.type_id())](visitor, fallback, operand);
+}
+
+template<class... Ts, class Visitor, class Any>
+decltype(auto) any_visit(Visitor&& visitor, Any& operand)
+{
+	using result = any_visit_detail::result_t<Visitor, Any, Ts...>;
+	return any_visit<Ts...>(std::forward<Visitor>(visitor), operand, any_visit_detail::throw_bad_any_cast<result>{});
+}
@@ -0,0 +1,518 @@
+#pragma once
+/*
+	<atomic_any> publishes a value to many threads without a lock: writers store(), exchange() or compare_exchange()
+	whole values, readers load() a snapshot, a read only view of the value that was current when they looked.
+
+	Every stored value lives in its own immutable node, allocated from Alloc like a big value's block, and the atomic_any
+	is just an atomic pointer to the current node. Replacing the value swings the pointer and retires the old node, which
+	is destroyed once no snapshot reads it anymore. That's decided with hazard pointers (any_hazard_pointers below): a
+	snapshot publishes the node it reads in a slot of its own, and retired nodes are only reclaimed when a scan of all
+	slots doesn't find them.
+
+	Taking a snapshot writes to the reader's own slot and nothing else (no shared reference count), so reads scale with
+	the number of cores. Writers pay for the new node and, every few dozen retirements, for a scan.
+
+	For a read-modify-write, copy the value out of a snapshot, change it, and compare_exchange it against the same
+	snapshot until nobody else got there first.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "any.h"
+
+// Safe memory reclamation for lock free readers, shared by every atomic_any.
+class any_hazard_pointers
+{
+public:
+	// The header of anything that can be retired, <reclaim> destroys and frees it.
+	struct retired
+	{
+		void (*reclaim)(retired*) noexcept;
+		retired* next;
+	};
+
+	// A hazard pointer slot. One per cache line, so readers publishing their pointers don't invalidate each other.
+	struct alignas(64) record
+	{
+		std::atomic<const retired*> pointer{ nullptr };
+		std::atomic<bool> active{ false };
+		record* next = nullptr; // every record ever created, records are never freed
+		record* next_free = nullptr; // the unused records of the thread that released them last
+	};
+
+	static constexpr size_t scan_threshold = 64;
+
+	// A slot for the calling thread, from its own free list if it can.
+	static record* acquire()
+	{
+		thread_state& s = local();
+
+		if (record* r = s.free)
+		{
+			s.free = r->next_free;
+			return r;
+		}
+
+		register_cleanup(s);
+
+		domain& d = global();
+		for (record* r = d.records.load(std::memory_order_acquire); r; r = r->next)
+		{
+			bool expected = false;
+			if (!r->active.load(std::memory_order_relaxed) && r->active.compare_exchange_strong(expected, true, std::memory_order_acquire))
+			{
+				return r;
+			}
+		}
+
+		record* r = new record;
+		r->active.store(true, std::memory_order_relaxed);
+		r->next = d.records.load(std::memory_order_relaxed);
+		while (!d.records.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+		d.record_count.fetch_add(1, std::memory_order_relaxed);
+		return r;
+	}
+
+	static void release(record* r) noexcept
+	{
+		r->pointer.store(nullptr, std::memory_order_release);
+
+		thread_state& s = local();
+		if (s.closed)
+		{
+			r->active.store(false, std::memory_order_release);
+			return;
+		}
+
+		r->next_free = s.free;
+		s.free = r;
+	}
+
+	// Publishes the current value of <source> in <r> and returns it. It can't be reclaimed until <r> is cleared.
+	template<class T>
+	static T* protect(record& r, const std::atomic<T*>& source) noexcept
+	{
+		static_assert(std::is_base_of_v<retired, T>);
+
+		T* p = source.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			// seq_cst like the writers' exchange and scan(): either scan() sees the slot or we see the new pointer
+			r.pointer.store(static_cast<const retired*>(p), std::memory_order_seq_cst);
+
+			T* current = source.load(std::memory_order_seq_cst);
+			if (current == p)
+			{
+				return p;
+			}
+			p = current;
+		}
+	}
+
+	// Hands over something nobody can newly reach, it's reclaimed once no slot points to it.
+	static void retire(retired* r) noexcept
+	{
+		thread_state& s = local();
+
+		if (s.closed)
+		{
+			r->next = nullptr;
+			orphan(r, r);
+			return;
+		}
+
+		register_cleanup(s);
+
+		r->next = s.list;
+		s.list = r;
+		++s.count;
+
+		if (s.count >= std::max(scan_threshold, 2 * global().record_count.load(std::memory_order_relaxed)))
+		{
+			scan(s);
+		}
+	}
+
+	// Reclaims what the calling thread retired, as far as it isn't protected anymore.
+	static void collect() noexcept
+	{
+		thread_state& s = local();
+		if (!s.closed)
+		{
+			scan(s);
+		}
+	}
+
+private:
+	// Constant initialized and never destroyed, so atomic_anys with static storage can retire until the very end.
+	struct domain
+	{
+		std::atomic<record*> records{ nullptr };
+		std::atomic<size_t> record_count{ 0 };
+		std::atomic<retired*> orphans{ nullptr }; // left behind by threads that exited
+	};
+
+	// Trivially destructible for the same reason as any_pool_allocator's cache: usable after the cleanup below ran.
+	struct thread_state
+	{
+		record* free;
+		retired* list;
+		size_t count;
+		bool registered;
+		bool closed;
+	};
+
+	struct thread_state_cleanup
+	{
+		~thread_state_cleanup()
+		{
+			thread_state& s = local();
+
+			while (record* r = s.free)
+			{
+				s.free = r->next_free; // before someone else can take it
+				r->active.store(false, std::memory_order_release);
+			}
+
+			scan(s);
+			if (s.list)
+			{
+				retired* last = s.list;
+				while (last->next)
+				{
+					last = last->next;
+				}
+				orphan(s.list, last);
+			}
+			s.list = nullptr;
+			s.count = 0;
+			s.closed = true;
+		}
+	};
+
+	static domain& global() noexcept
+	{
+		static domain d;
+		return d;
+	}
+
+	static thread_state& local() noexcept
+	{
+		static thread_local thread_state s{};
+		return s;
+	}
+
+	static void register_cleanup(thread_state& s) noexcept
+	{
+		if (!s.registered)
+		{
+			static thread_local thread_state_cleanup cleanup;
+			(void)cleanup;
+			s.registered = true;
+		}
+	}
+
+	static void orphan(retired* first, retired* last) noexcept
+	{
+		domain& d = global();
+		last->next = d.orphans.load(std::memory_order_relaxed);
+		while (!d.orphans.compare_exchange_weak(last->next, first, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	static void scan(thread_state& s) noexcept
+	{
+		domain& d = global();
+
+		// adopt what exited threads couldn't reclaim
+		if (retired* orphans = d.orphans.exchange(nullptr, std::memory_order_acquire))
+		{
+			retired* last = orphans;
+			for (++s.count; last->next; last = last->next)
+			{
+				++s.count;
+			}
+			last->next = s.list;
+			s.list = orphans;
+		}
+
+		std::vector<const retired*> hazards;
+		try
+		{
+			hazards.reserve(d.record_count.load(std::memory_order_relaxed));
+			for (record* r = d.records.load(std::memory_order_acquire); r; r = r->next)
+			{
+				if (const retired* p = r->pointer.load(std::memory_order_seq_cst))
+				{
+					hazards.push_back(p);
+				}
+			}
+		}
+		catch (...)
+		{
+			return; // try again on the next retire
+		}
+		std::sort(hazards.begin(), hazards.end());
+
+		// reclaiming runs destructors that may retire again, so work on a detached list
+		retired* list = std::exchange(s.list, nullptr);
+		s.count = 0;
+
+		while (list)
+		{
+			retired* r = list;
+			list = r->next;
+
+			if (std::binary_search(hazards.begin(), hazards.end(), r))
+			{
+				r->next = s.list;
+				s.list = r;
+				++s.count;
+			}
+			else
+			{
+				r->reclaim(r);
+			}
+		}
+	}
+};
+
+template<size_t Capacity, size_t Align, class Alloc = any_pool_allocator>
+class basic_atomic_any
+{
+	struct node;
+
+public:
+	using value_type = basic_any<Capacity, Align, Alloc>;
+	using allocator_type = Alloc;
+
+	// The value some load() saw. It stays alive, and unchanged, for as long as the snapshot does.
+	class snapshot
+	{
+	public:
+		snapshot() noexcept = default;
+
+		snapshot(snapshot&& other) noexcept
+			:_record{ std::exchange(other._record, nullptr) },
+			_node{ std::exchange(other._node, nullptr) }
+		{
+		}
+
+		snapshot& operator=(snapshot&& rhs) noexcept
+		{
+			snapshot(std::move(rhs)).swap(*this);
+			return *this;
+		}
+
+		~snapshot()
+		{
+			if (_record)
+			{
+				any_hazard_pointers::release(_record);
+			}
+		}
+
+		void swap(snapshot& rhs) noexcept
+		{
+			std::swap(_record, rhs._record);
+			std::swap(_node, rhs._node);
+		}
+
+		// An empty any when the atomic_any had no value.
+		const value_type& operator*() const noexcept
+		{
+			return _node ? _node->value : empty();
+		}
+
+		const value_type* operator->() const noexcept
+		{
+			return &**this;
+		}
+
+		bool has_value() const noexcept
+		{
+			return _node != nullptr;
+		}
+
+	private:
+		friend class basic_atomic_any;
+
+		snapshot(any_hazard_pointers::record* record, const node* n) noexcept
+			:_record{ record },
+			_node{ n }
+		{
+		}
+
+		static const value_type& empty() noexcept
+		{
+			static const value_type e;
+			return e;
+		}
+
+		any_hazard_pointers::record* _record = nullptr;
+		const node* _node = nullptr;
+	};
+
+	constexpr basic_atomic_any() noexcept
+		:_alloc{}
+	{
+	}
+
+	explicit basic_atomic_any(value_type value)
+		:_alloc{}
+	{
+		_head.store(make_node(std::move(value)), std::memory_order_relaxed);
+	}
+
+	basic_atomic_any(std::allocator_arg_t, const Alloc& alloc) noexcept
+		:_alloc{ alloc }
+	{
+	}
+
+	basic_atomic_any(std::allocator_arg_t, const Alloc& alloc, value_type value)
+		:_alloc{ alloc }
+	{
+		_head.store(make_node(std::move(value)), std::memory_order_relaxed);
+	}
+
+	basic_atomic_any(const basic_atomic_any&) = delete;
+	basic_atomic_any& operator=(const basic_atomic_any&) = delete;
+
+	// Snapshots taken earlier keep the last value alive.
+	~basic_atomic_any()
+	{
+		retire(_head.load(std::memory_order_relaxed));
+	}
+
+	snapshot load() const
+	{
+		any_hazard_pointers::record* record = any_hazard_pointers::acquire();
+		return { record, any_hazard_pointers::protect(*record, _head) };
+	}
+
+	void store(value_type desired)
+	{
+		retire(_head.exchange(make_node(std::move(desired)), std::memory_order_seq_cst));
+	}
+
+	// The value that was replaced, as a snapshot so it isn't copied.
+	snapshot exchange(value_type desired)
+	{
+		node* n = make_node(std::move(desired));
+		snapshot previous{ any_hazard_pointers::acquire(), nullptr };
+
+		// we own the old node until we retire it, so protecting it afterwards is fine
+		previous._node = _head.exchange(n, std::memory_order_seq_cst);
+		previous._record->pointer.store(previous._node, std::memory_order_relaxed);
+		retire(const_cast<node*>(previous._node));
+		return previous;
+	}
+
+	// Stores <desired> if the value is still the one <expected> saw (the same store, not an equal value).
+	// Otherwise <expected> is updated to the current value and <desired> is dropped.
+	bool compare_exchange(snapshot& expected, value_type desired)
+	{
+		node* current = const_cast<node*>(expected._node);
+
+		if (_head.load(std::memory_order_relaxed) == current)
+		{
+			node* n = make_node(std::move(desired));
+			if (_head.compare_exchange_strong(current, n, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				retire(current);
+				return true;
+			}
+			if (n)
+			{
+				destroy_node(n);
+			}
+		}
+
+		if (!expected._record)
+		{
+			expected._record = any_hazard_pointers::acquire();
+		}
+		expected._node = any_hazard_pointers::protect(*expected._record, _head);
+		return false;
+	}
+
+	bool is_lock_free() const noexcept
+	{
+		return _head.is_lock_free();
+	}
+
+	Alloc get_allocator() const noexcept
+	{
+		return _alloc;
+	}
+
+private:
+	struct node : any_hazard_pointers::retired
+	{
+		node(const Alloc& alloc, value_type&& v)
+			:retired{ &reclaim, nullptr },
+			value(std::allocator_arg, alloc, std::move(v))
+		{
+		}
+
+		static void reclaim(any_hazard_pointers::retired* r) noexcept
+		{
+			destroy_node(static_cast<node*>(r));
+		}
+
+		value_type value;
+	};
+
+	// Empty values aren't stored, the pointer is null.
+	node* make_node(value_type&& value)
+	{
+		if (!value.has_value())
+		{
+			return nullptr;
+		}
+
+		void* block = _alloc.allocate(sizeof(node), alignof(node));
+		try
+		{
+			return ::new(block) node(_alloc, std::move(value));
+		}
+		catch (...)
+		{
+			_alloc.deallocate(block, sizeof(node), alignof(node));
+			throw;
+		}
+	}
+
+	static void destroy_node(node* n) noexcept
+	{
+		Alloc alloc = n->value.get_allocator();
+		std::destroy_at(n);
+		alloc.deallocate(n, sizeof(node), alignof(node));
+	}
+
+	static void retire(node* n) noexcept
+	{
+		if (n)
+		{
+			any_hazard_pointers::retire(n);
+		}
+	}
+
+	std::atomic<node*> _head{ nullptr };
+	Alloc _alloc;
+};
+
+using atomic_any = basic_atomic_any<small_space_size, small_space_align>;
+
+namespace pmr
+{
+	template<size_t Capacity, size_t Align>
+	using basic_atomic_any = ::basic_atomic_any<Capacity, Align, any_resource_allocator>;
+
+	using atomic_any = basic_atomic_any<small_space_size, small_space_align>;
+}
@@ -0,0 +1,448 @@
+#pragma once
+/*
+	<compact_any> is an <any> one pointer wide, for containers of mostly big values where the inline buffer of <any> is
+	dead weight: a std::vector<compact_any> is 8 bytes per element instead of 72.
+
+	The value lives in a single heap block that starts with a header, the pointer to the handler table of its type,
+	followed by the object. The compact_any itself is nothing but the pointer to that block, so moving one copies a word
+	and swapping two swaps them, whatever they hold. Copies allocate a new block through the table.
+
+	On 64 bit targets the few types listed in compact_any_inline_types (bool, the small integers and float) skip the heap
+	altogether: they're stored in the word itself next to a tag. Block pointers are at least pointer aligned, so a set low
+	bit marks a tagged value and the next three bits give its index in the list, the value takes the other half of the
+	word. Empty is the null pointer.
+
+		null            empty
+		...xxx1         a compact_any_inline_types[xxx] in the other half of the word
+		block           -> { const compact_any_handler*, T }
+
+	There's no room for an allocator, so only stateless ones (any_pool_allocator, any_heap_allocator) can be used.
+*/
+
+#include <cstring>
+#include <tuple>
+
+#include "any.h"
+
+// The types a compact_any stores tagged inside its word, at most 8 of at most 4 bytes each.
+using compact_any_inline_types = std::tuple<bool, char, unsigned char, short, unsigned short, int, unsigned int, float>;
+
+// The table of a type stored in a block, pointed to by the block's header.
+struct compact_any_handler
+{
+	void (*_destroy)(void* block) noexcept; // destroys the object and frees the block
+	void* (*_copy)(const void* block); // a new block holding a copy of the object
+	any_type_id _id;
+#if ANY_HAS_RTTI
+	const std::type_info& (*_type)() noexcept;
+#endif
+#if ANY_ENABLE_STATS
+	any_type_stats* _stats;
+#endif
+};
+
+template<class T, class Alloc>
+struct compact_any_block
+{
+	static constexpr size_t offset = (sizeof(const compact_any_handler*) + alignof(T) - 1) & ~(alignof(T) - 1);
+	static constexpr size_t size = offset + sizeof(T);
+	static constexpr size_t align = alignof(T) > alignof(const compact_any_handler*) ? alignof(T) : alignof(const compact_any_handler*);
+
+	static T* object(void* block) noexcept
+	{
+		return reinterpret_cast<T*>(static_cast<unsigned char*>(block) + offset);
+	}
+
+	template<class... Args>
+	static void* Make(Args&&... args);
+
+	static void Destroy(void* block) noexcept
+	{
+		std::destroy_at(object(block));
+		Alloc{}.deallocate(block, size, align);
+	}
+
+	static void* Copy(const void* block)
+	{
+		ANY_STATS_COUNT_TYPE(T, copies, 1);
+		return Make(*object(const_cast<void*>(block)));
+	}
+};
+
+template<class T, class Alloc>
+struct compact_any_handlers
+{
+	static const compact_any_handler table;
+};
+
+template<class T, class Alloc>
+constexpr compact_any_handler compact_any_handlers<T, Alloc>::table = { &compact_any_block<T, Alloc>::Destroy, &compact_any_block<T, Alloc>::Copy,
+	any_type_id_of<T>()
+#if ANY_HAS_RTTI
+	, &any_type<T>
+#endif
+#if ANY_ENABLE_STATS
+	, &any_stats_of<T>::record
+#endif
+};
+
+template<class T, class Alloc>
+template<class... Args>
+void* compact_any_block<T, Alloc>::Make(Args&&... args)
+{
+	ANY_STATS_COUNT_TYPE(T, bytes_allocated, size);
+	void* block = Alloc{}.allocate(size, align);
+	try
+	{
+		Construct<T>(object(block), std::forward<Args>(args)...);
+	}
+	catch (...)
+	{
+		Alloc{}.deallocate(block, size, align);
+		throw;
+	}
+	*static_cast<const compact_any_handler**>(block) = &compact_any_handlers<T, Alloc>::table;
+	return block;
+}
+
+// The index of T in List, or List's size. cv-qualifiers are dropped, any_cast<const int> reads a tagged int.
+template<class T, class List = compact_any_inline_types>
+struct compact_any_inline_index;
+
+template<class T, class... Ts>
+struct compact_any_inline_index<T, std::tuple<Ts...>>
+{
+	static constexpr size_t npos = sizeof...(Ts);
+
+	static constexpr size_t value = []
+	{
+		constexpr bool matches[] = { std::is_same_v<std::remove_cv_t<T>, Ts>... };
+		for (size_t i = 0; i < sizeof...(Ts); ++i)
+		{
+			if (matches[i])
+			{
+				return i;
+			}
+		}
+		return npos;
+	}();
+};
+
+template<class List = compact_any_inline_types>
+struct compact_any_inline_tables;
+
+template<class... Ts>
+struct compact_any_inline_tables<std::tuple<Ts...>>
+{
+	static_assert(sizeof...(Ts) <= 8, "the tag has room for 8 inline types");
+	static_assert(((sizeof(Ts) <= sizeof(void*) / 2 && std::is_trivially_copyable_v<Ts>) && ...), "inline types must be trivially copyable and fit in half a pointer");
+
+	static constexpr any_type_id ids[] = { any_type_id_of<Ts>()... };
+#if ANY_HAS_RTTI
+	static constexpr const std::type_info* types[] = { &typeid(Ts)... };
+#endif
+};
+
+template<class Alloc = any_pool_allocator>
+class basic_compact_any;
+
+template<class T>
+struct is_basic_compact_any : std::false_type {};
+
+template<class Alloc>
+struct is_basic_compact_any<basic_compact_any<Alloc>> : std::true_type {};
+
+// Only a pointer or a trivially copyable value.
+template<class Alloc>
+struct is_trivially_relocatable<basic_compact_any<Alloc>> : std::true_type {};
+
+template<class Alloc>
+class basic_compact_any
+{
+	static_assert(std::is_empty_v<Alloc>, "compact_any has no room for an allocator, use a stateless one");
+
+	// Tagging needs the other half of the word to hold the value.
+	static constexpr bool tagging = sizeof(void*) >= 8;
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	static constexpr size_t payload_offset = 0; // the low bits, and the tag, are in the last byte
+#else
+	static constexpr size_t payload_offset = sizeof(void*) / 2;
+#endif
+
+public:
+	using allocator_type = Alloc;
+
+	// Whether T is stored in the word instead of a block.
+	template<class T>
+	using is_inline = std::bool_constant<tagging && compact_any_inline_index<T>::value != compact_any_inline_index<T>::npos>;
+
+	constexpr basic_compact_any() noexcept
+		:_word{}
+	{
+	}
+
+	basic_compact_any(const basic_compact_any& other)
+		:_word{}
+	{
+		copy_from(other);
+	}
+
+	basic_compact_any(basic_compact_any&& other) noexcept
+		:_word{}
+	{
+		std::memcpy(_word, other._word, sizeof(_word));
+		other.set_bits(0);
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_compact_any<VT>::value
+										   && std::is_copy_constructible_v<VT>>>
+	basic_compact_any(T&& value)
+		:_word{}
+	{
+		emplace<VT>(std::forward<T>(value));
+	}
+
+	template<class T, class... Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+											       && std::is_constructible_v<VT, Args...>>>
+	explicit basic_compact_any(std::in_place_type_t<T>, Args&&... args)
+		:_word{}
+	{
+		emplace<VT>(std::forward<Args>(args)...);
+	}
+
+	template<class T, class U, class...Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+													 && std::is_constructible_v<VT, std::initializer_list<U>&, Args...>>>
+	explicit basic_compact_any(std::in_place_type_t<T>, std::initializer_list<U> il, Args&&... args)
+		:_word{}
+	{
+		emplace<VT>(il, std::forward<Args>(args)...);
+	}
+
+	~basic_compact_any()
+	{
+		reset();
+	}
+
+	basic_compact_any& operator=(const basic_compact_any& rhs)
+	{
+		basic_compact_any(rhs).swap(*this);
+		return *this;
+	}
+
+	basic_compact_any& operator=(basic_compact_any&& rhs) noexcept
+	{
+		basic_compact_any(std::move(rhs)).swap(*this);
+		return *this;
+	}
+
+	// Assigns in place when we hold a VT already.
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_compact_any<VT>::value
+										   && std::is_copy_constructible_v<VT>>>
+	basic_compact_any& operator=(T&& rhs)
+	{
+		if constexpr (std::is_assignable_v<VT&, T>)
+		{
+			if (type_id() == any_type_id_of<VT>())
+			{
+				*get_val<VT>() = std::forward<T>(rhs);
+				return *this;
+			}
+		}
+
+		emplace<VT>(std::forward<T>(rhs));
+		return *this;
+	}
+
+	// A new block is made before the old value is destroyed, so a throwing constructor leaves the old value in place.
+	template<class T, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+												 && std::is_constructible_v<VT, Args...>>>
+	std::decay_t<T>& emplace(Args&&... args)
+	{
+		if constexpr (is_inline<VT>::value)
+		{
+			const VT value(std::forward<Args>(args)...);
+			reset();
+			ANY_STATS_COUNT_TYPE(VT, small_emplaces, 1);
+			set_bits(1 | (compact_any_inline_index<VT>::value << 1));
+			Construct<VT>(_word + payload_offset, value);
+		}
+		else
+		{
+			ANY_STATS_COUNT_TYPE(VT, big_emplaces, 1);
+			void* block = compact_any_block<VT, Alloc>::Make(std::forward<Args>(args)...);
+			reset();
+			set_bits(reinterpret_cast<uintptr_t>(block));
+		}
+		return *get_val<VT>();
+	}
+
+	template<class T, class U, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+													  && std::is_constructible_v<VT, std::initializer_list<U>&, Args...>>>
+	std::decay_t<T>& emplace(std::initializer_list<U> il, Args&&... args)
+	{
+		ANY_STATS_COUNT_TYPE(VT, big_emplaces, 1);
+		void* block = compact_any_block<VT, Alloc>::Make(il, std::forward<Args>(args)...);
+		reset();
+		set_bits(reinterpret_cast<uintptr_t>(block));
+		return *get_val<VT>();
+	}
+
+	void reset() noexcept
+	{
+		const uintptr_t bits = get_bits();
+
+		if (bits && !(bits & 1))
+		{
+			handler()->_destroy(block());
+		}
+		set_bits(0);
+	}
+
+	void swap(basic_compact_any& rhs) noexcept
+	{
+		std::swap(_word, rhs._word);
+	}
+
+	Alloc get_allocator() const noexcept
+	{
+		return Alloc{};
+	}
+
+	bool has_value() const noexcept
+	{
+		return get_bits() != 0;
+	}
+
+	any_type_id type_id() const noexcept
+	{
+		const uintptr_t bits = get_bits();
+
+		if (!bits)
+		{
+			return any_type_id_of<void>();
+		}
+		return bits & 1 ? compact_any_inline_tables<>::ids[(bits >> 1) & 7] : handler()->_id;
+	}
+
+#if ANY_HAS_RTTI
+	const std::type_info& type() const noexcept
+	{
+		const uintptr_t bits = get_bits();
+
+		if (!bits)
+		{
+			return typeid(void);
+		}
+		return bits & 1 ? *compact_any_inline_tables<>::types[(bits >> 1) & 7] : handler()->_type();
+	}
+#endif
+
+	template<class T>
+	T* get_val() noexcept
+	{
+		if constexpr (is_inline<T>::value)
+		{
+			return reinterpret_cast<T*>(_word + payload_offset);
+		}
+		else
+		{
+			return compact_any_block<T, Alloc>::object(block());
+		}
+	}
+
+	template<class T>
+	const T* get_val() const noexcept
+	{
+		return const_cast<basic_compact_any*>(this)->get_val<T>();
+	}
+
+private:
+	uintptr_t get_bits() const noexcept
+	{
+		uintptr_t bits;
+		std::memcpy(&bits, _word, sizeof(bits));
+		return bits;
+	}
+
+	void set_bits(uintptr_t bits) noexcept
+	{
+		std::memcpy(_word, &bits, sizeof(bits));
+	}
+
+	void* block() const noexcept
+	{
+		return reinterpret_cast<void*>(get_bits());
+	}
+
+	const compact_any_handler* handler() const noexcept
+	{
+		return *static_cast<const compact_any_handler* const*>(block());
+	}
+
+	void copy_from(const basic_compact_any& other)
+	{
+		const uintptr_t bits = other.get_bits();
+
+		if (bits && !(bits & 1))
+		{
+			set_bits(reinterpret_cast<uintptr_t>(other.handler()->_copy(other.block())));
+		}
+		else
+		{
+			std::memcpy(_word, other._word, sizeof(_word));
+		}
+	}
+
+	alignas(void*) unsigned char _word[sizeof(void*)];
+};
+
+using compact_any = basic_compact_any<>;
+
+template<class Alloc>
+inline void swap(basic_compact_any<Alloc>& x, basic_compact_any<Alloc>& y) noexcept
+{
+	x.swap(y);
+}
+
+template<class T, class... Args>
+compact_any make_compact_any(Args&&... args)
+{
+	return compact_any{ std::in_place_type<T>, std::forward<Args>(args)... };
+}
+
+template<class T, class U, class... Args>
+compact_any make_compact_any(std::initializer_list<U> il, Args&&... args)
+{
+	return compact_any{ std::in_place_type<T>, il, std::forward<Args>(args)... };
+}
+
+template<class T, class Alloc>
+T any_cast(const basic_compact_any<Alloc>& operand)
+{
+	return any_cast_impl::value<T>(operand);
+}
+
+template<class T, class Alloc>
+T any_cast(basic_compact_any<Alloc>& operand)
+{
+	return any_cast_impl::value<T>(operand);
+}
+
+template<class T, class Alloc>
+T any_cast(basic_compact_any<Alloc>&& operand)
+{
+	return any_cast_impl::value<T>(std::move(operand));
+}
+
+template<class T, class Alloc>
+const T* any_cast(const basic_compact_any<Alloc>* operand) noexcept
+{
+	return any_cast_impl::pointer<T>(operand);
+}
+
+template<class T, class Alloc>
+T* any_cast(basic_compact_any<Alloc>* operand) noexcept
+{
+	return any_cast_impl::pointer<T>(operand);
+}
@@ -0,0 +1,428 @@
+#pragma once
+/*
+	<shared_any> is a copy-on-write <any> for large payloads that are copied a lot but rarely changed (configuration
+	snapshots, lookup tables fanned out to many consumers).
+
+	It is built on the same any_storage as basic_any (see any.h). Small values are stored inline and copied like in
+	basic_any. Big values live in a reference counted block, so copying a shared_any only bumps an atomic counter. The
+	value is deep copied the first time someone takes mutable access (any_cast<T&>, any_cast<T*>, any_cast<T&&>) while
+	the block is shared, const access never copies. Because of that, the mutable casts can allocate and throw, unlike the
+	ones of basic_any.
+
+	The T& or T* a mutable access hands out stays writable after it returns, so from then on the block is unshareable:
+	copies of that any deep copy the value instead of sharing it, or writes through the reference would show up in them.
+	Storing a new value (assignment, emplace) makes a new, shareable block.
+
+	Blocks are only shared between anys with equal allocators: copy construction propagates the allocator, and
+	assignment into an any with a different allocator makes a deep copy in the target's allocator, so whoever drops the
+	last reference can always free the block.
+
+	Copies can be used from different threads: the counter is atomic, and a block is only written through a mutable
+	access, which makes it the any's own first and unshareable for good.
+*/
+
+#include <atomic>
+
+#include "any.h"
+
+// The header of a big value's block, the value follows it.
+struct shared_any_block
+{
+	std::atomic<size_t> refs;
+	bool unshareable; // mutable access was handed out, only ever set while refs is 1
+};
+
+template<class T>
+struct shared_any_value : shared_any_block
+{
+	template<class... Args>
+	shared_any_value(Args&&... args)
+		:shared_any_block{ 1, false },
+		value(std::forward<Args>(args)...)
+	{
+	}
+
+	T value;
+};
+
+// The reference count is handled by basic_shared_any, the handlers only see a block when it's created or freed.
+struct shared_any_handler
+{
+	void (*_destroy)(void* storage, void* alloc) noexcept; // big: frees the block, the last reference is gone
+	void (*_copy)(void* destination, const void* source, void* alloc); // always a deep copy, big: into a new block
+	void (*_move)(void* destination, void* source) noexcept; // leaves <source> without a value
+	any_type_id _id;
+	any_representation _representation;
+	bool _trivially_relocatable; // the storage, so always true for big values
+#if ANY_HAS_RTTI
+	const std::type_info& (*_type)() noexcept;
+#endif
+#if ANY_ENABLE_STATS
+	any_type_stats* _stats;
+#endif
+};
+
+struct shared_any_big
+{
+	template<class T, class Alloc>
+	static void Destroy(void* storage, void* alloc) noexcept
+	{
+		auto* block = *static_cast<shared_any_value<T>**>(storage);
+		std::destroy_at(block);
+		static_cast<Alloc*>(alloc)->deallocate(block, sizeof(shared_any_value<T>), alignof(shared_any_value<T>));
+	}
+
+	template<class T, class Alloc>
+	static void Copy(void* destination, const void* source, void* alloc)
+	{
+		ANY_STATS_COUNT_TYPE(T, copies, 1);
+		Create<T>(destination, *static_cast<Alloc*>(alloc), (*static_cast<shared_any_value<T>* const*>(source))->value);
+	}
+
+	template<class T, class Alloc, class... Args>
+	static T& Create(void* storage, Alloc& allocator, Args&&... args)
+	{
+		ANY_STATS_COUNT_TYPE(T, bytes_allocated, sizeof(shared_any_value<T>));
+		void* block = allocator.allocate(sizeof(shared_any_value<T>), alignof(shared_any_value<T>));
+		try
+		{
+			Construct<shared_any_value<T>>(block, std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			allocator.deallocate(block, sizeof(shared_any_value<T>), alignof(shared_any_value<T>));
+			throw;
+		}
+		*static_cast<void**>(storage) = block;
+		return static_cast<shared_any_value<T>*>(block)->value;
+	}
+};
+
+template<class T, class Alloc>
+struct shared_any_handlers
+{
+	static const shared_any_handler small;
+	static const shared_any_handler big;
+};
+
+template<class T, class Alloc>
+constexpr shared_any_handler shared_any_handlers<T, Alloc>::small = { &any_small::Destroy<T>, &any_small::Copy<T>, &any_small::Move<T>,
+	any_type_id_of<T>(), any_representation::Small, is_trivially_relocatable_v<T>
+#if ANY_HAS_RTTI
+	, &any_type<T>
+#endif
+#if ANY_ENABLE_STATS
+	, &any_stats_of<T>::record
+#endif
+};
+
+template<class T, class Alloc>
+constexpr shared_any_handler shared_any_handlers<T, Alloc>::big = { &shared_any_big::Destroy<T, Alloc>, &shared_any_big::Copy<T, Alloc>, &any_big::Move<T>,
+	any_type_id_of<T>(), any_representation::Big, true
+#if ANY_HAS_RTTI
+	, &any_type<T>
+#endif
+#if ANY_ENABLE_STATS
+	, &any_stats_of<T>::record
+#endif
+};
+
+template<size_t Capacity, size_t Align, class Alloc = any_pool_allocator>
+class basic_shared_any;
+
+template<class T>
+struct is_basic_shared_any : std::false_type {};
+
+template<size_t Capacity, size_t Align, class Alloc>
+struct is_basic_shared_any<basic_shared_any<Capacity, Align, Alloc>> : std::true_type {};
+
+template<size_t Capacity, size_t Align, class Alloc>
+class basic_shared_any : public any_storage<basic_shared_any<Capacity, Align, Alloc>, shared_any_handler, Capacity, Align, Alloc, false>
+{
+	using base = any_storage<basic_shared_any, shared_any_handler, Capacity, Align, Alloc, false>;
+
+	friend base;
+
+	template<class T>
+	using handlers = shared_any_handlers<T, Alloc>;
+
+	using typename base::storage;
+	using base::_storage;
+	using base::allocator;
+	using base::buffer;
+	using base::relocate;
+
+public:
+	constexpr basic_shared_any() noexcept
+		:base{}
+	{
+	}
+
+	basic_shared_any(std::allocator_arg_t, const Alloc& alloc) noexcept
+		:base{ alloc }
+	{
+	}
+
+	// Big values are shared, not copied.
+	basic_shared_any(const basic_shared_any& other)
+		:base{ other.get_allocator() }
+	{
+		copy_from(other);
+	}
+
+	basic_shared_any(std::allocator_arg_t, const Alloc& alloc, const basic_shared_any& other)
+		:base{ alloc }
+	{
+		copy_from(other);
+	}
+
+	basic_shared_any(basic_shared_any&& other) noexcept
+		:base{ other.get_allocator() }
+	{
+		relocate(_storage, other._storage);
+	}
+
+	// Deep copies a big value when the allocators differ.
+	basic_shared_any(std::allocator_arg_t, const Alloc& alloc, basic_shared_any&& other)
+		:base{ alloc }
+	{
+		if (is_big(other._storage) && !(allocator() == other.allocator()))
+		{
+			copy_from(other);
+			other.reset();
+		}
+		else
+		{
+			relocate(_storage, other._storage);
+			static_cast<Alloc&>(_storage) = alloc;
+		}
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_shared_any<VT>::value
+										   && std::is_copy_constructible_v<VT>>>
+	basic_shared_any(T&& value)
+		:base{ Alloc{} }
+	{
+		emplace<VT>(std::forward<T>(value));
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_shared_any<VT>::value
+										   && std::is_copy_constructible_v<VT>>>
+	basic_shared_any(std::allocator_arg_t, const Alloc& alloc, T&& value)
+		:base{ alloc }
+	{
+		emplace<VT>(std::forward<T>(value));
+	}
+
+	template<class T, class... Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+											       && std::is_constructible_v<VT, Args...>>>
+	explicit basic_shared_any(std::in_place_type_t<T>, Args&&... args)
+		:base{ Alloc{} }
+	{
+		emplace<VT>(std::forward<Args>(args)...);
+	}
+
+	template<class T, class U, class...Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+													 && std::is_constructible_v<VT, std::initializer_list<U>&, Args...>>>
+	explicit basic_shared_any(std::in_place_type_t<T>, std::initializer_list<U> il, Args&&... args)
+		:base{ Alloc{} }
+	{
+		emplace<VT>(il, std::forward<Args>(args)...);
+	}
+
+	~basic_shared_any()
+	{
+		reset();
+	}
+
+	basic_shared_any& operator=(const basic_shared_any& rhs)
+	{
+		basic_shared_any(std::allocator_arg, this->get_allocator(), rhs).swap(*this);
+		return *this;
+	}
+
+	basic_shared_any& operator=(basic_shared_any&& rhs) noexcept(Alloc::is_always_equal::value)
+	{
+		basic_shared_any(std::allocator_arg, this->get_allocator(), std::move(rhs)).swap(*this);
+		return *this;
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_shared_any<VT>::value
+										   && std::is_copy_constructible_v<VT>>>
+	basic_shared_any& operator=(T&& rhs)
+	{
+		basic_shared_any(std::allocator_arg, this->get_allocator(), std::forward<T>(rhs)).swap(*this);
+		return *this;
+	}
+
+	template<class T, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+												 && std::is_constructible_v<VT, Args...>>>
+	std::decay_t<T>& emplace(Args&&... args)
+	{
+		reset();
+		return emplace_impl<VT>(std::forward<Args>(args)...);
+	}
+
+	template<class T, class U, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+													  && std::is_constructible_v<VT, std::initializer_list<U>&, Args...>>>
+	std::decay_t<T>& emplace(std::initializer_list<U> il, Args&&... args)
+	{
+		reset();
+		return emplace_impl<VT>(il, std::forward<Args>(args)...);
+	}
+
+	// Drops our reference, the value is destroyed with the last one.
+	void reset() noexcept
+	{
+		if (!this->has_value())
+		{
+			return;
+		}
+
+		if (!is_big(_storage) || block()->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			_storage.handler->_destroy(buffer(), &allocator());
+		}
+		_storage.handler = nullptr;
+	}
+
+	// How many anys share the value: 0 without one, always 1 for small values.
+	size_t use_count() const noexcept
+	{
+		if (!this->has_value())
+		{
+			return 0;
+		}
+
+		return is_big(_storage) ? block()->refs.load(std::memory_order_acquire) : 1;
+	}
+
+	// Mutable access, makes the value our own first and keeps it that way, see unshareable.
+	template<class T>
+	T* get_val()
+	{
+		if constexpr (base::template is_small<T>::value)
+		{
+			return static_cast<T*>(buffer());
+		}
+		else
+		{
+			if (block()->refs.load(std::memory_order_acquire) != 1)
+			{
+				basic_shared_any copy(std::allocator_arg, this->get_allocator());
+				_storage.handler->_copy(copy.buffer(), buffer(), &copy.allocator());
+				copy._storage.handler = _storage.handler;
+				copy.swap(*this); // <copy> drops our old reference
+			}
+			block()->unshareable = true;
+			return &static_cast<shared_any_value<T>*>(block())->value;
+		}
+	}
+
+	template<class T>
+	const T* get_val() const noexcept
+	{
+		if constexpr (base::template is_small<T>::value)
+		{
+			return static_cast<const T*>(buffer());
+		}
+		else
+		{
+			return &static_cast<const shared_any_value<T>*>(block())->value;
+		}
+	}
+
+private:
+	shared_any_block* block() const noexcept
+	{
+		return *reinterpret_cast<shared_any_block* const*>(_storage.buffer);
+	}
+
+	static bool is_big(const storage& s) noexcept
+	{
+		return s.handler && s.handler->_representation == any_representation::Big;
+	}
+
+	// Shares the block when our allocators agree and nobody holds a mutable reference into it, copies the value otherwise.
+	void copy_from(const basic_shared_any& other)
+	{
+		const shared_any_handler* handler = other._storage.handler;
+
+		if (!handler)
+		{
+			return;
+		}
+
+		if (is_big(other._storage) && !other.block()->unshareable && allocator() == other.get_allocator())
+		{
+			other.block()->refs.fetch_add(1, std::memory_order_relaxed);
+			std::memcpy(buffer(), other.buffer(), sizeof(void*));
+		}
+		else
+		{
+			handler->_copy(buffer(), other.buffer(), &allocator());
+		}
+
+		_storage.handler = handler;
+	}
+
+	// Expects no value. Big values go in a new reference counted block.
+	template<class T, class... Args>
+	T& emplace_impl(Args&&... args)
+	{
+		if constexpr (base::template is_small<T>::value)
+		{
+			return this->template emplace_small<T>(std::forward<Args>(args)...);
+		}
+		else
+		{
+			ANY_STATS_COUNT_TYPE(T, big_emplaces, 1);
+			T& value = shared_any_big::Create<T>(buffer(), allocator(), std::forward<Args>(args)...);
+			_storage.handler = &shared_any_handlers<T, Alloc>::big;
+			return value;
+		}
+	}
+};
+
+using shared_any = basic_shared_any<small_space_size, small_space_align>;
+
+namespace pmr
+{
+	template<size_t Capacity, size_t Align>
+	using basic_shared_any = ::basic_shared_any<Capacity, Align, any_resource_allocator>;
+
+	using shared_any = basic_shared_any<small_space_size, small_space_align>;
+}
+
+template<size_t Capacity, size_t Align, class Alloc>
+inline void swap(basic_shared_any<Capacity, Align, Alloc>& x, basic_shared_any<Capacity, Align, Alloc>& y) noexcept
+{
+	x.swap(y);
+}
+
+template<class T, class... Args>
+shared_any make_shared_any(Args&&... args)
+{
+	return shared_any{std::in_place_type<T>, std::forward<Args>(args)...};
+}
+
+template<class T, class U, class... Args>
+shared_any make_shared_any(std::initializer_list<U> il, Args&&... args)
+{
+	return shared_any{std::in_place_type<T>, il, std::forward<Args>(args)...};
+}
+
+// Only unshares the value for T&, copies and const references read the shared one. The other casts are any_storage's,
+// where the mutable pointer form is the one that unshares.
+template<class T, size_t Capacity, size_t Align, class Alloc>
+T any_cast(basic_shared_any<Capacity, Align, Alloc>& operand)
+{
+	if constexpr (std::is_lvalue_reference_v<T> && !std::is_const_v<std::remove_reference_t<T>>)
+	{
+		return any_cast_impl::value<T>(operand);
+	}
+	else
+	{
+		return any_cast_impl::value<T>(std::as_const(operand));
+	}
+}
@@ -0,0 +1,338 @@
+#pragma once
+/*
+	<static_any> is an <any> without a big representation, for code where a heap allocation is a bug (real-time threads,
+	signal handlers, allocation free hot paths).
+
+	Values always live in the Capacity/Align buffer. A type that doesn't fit, or that could throw while being copied or
+	moved, is rejected by a static_assert when it's stored instead of silently going to the heap. With those types every
+	operation is noexcept and none of them allocates or takes a lock, only any_cast<T> by value or reference throws
+	bad_any_cast on a type mismatch, the pointer form doesn't.
+
+	The handler tables only hold the small operations (any_small from any.h), there's no allocator.
+*/
+
+#include <algorithm>
+
+#include "any.h"
+
+// any_handler without the allocator and the big representation
+struct static_any_handler
+{
+	void (*_destroy)(void* object, void* unused) noexcept;
+	void (*_copy)(void* destination, const void* source, void* unused); // never throws, the stored types can't
+	void (*_move)(void* destination, void* source) noexcept; // leaves <source> without a value
+	any_type_id _id;
+	size_t _size;
+	size_t _align;
+	bool _trivially_relocatable;
+#if ANY_HAS_RTTI
+	const std::type_info& (*_type)() noexcept;
+#endif
+#if ANY_ENABLE_STATS
+	any_type_stats* _stats;
+#endif
+};
+
+template<class T>
+struct static_any_handlers
+{
+	static const static_any_handler table;
+};
+
+template<class T>
+constexpr static_any_handler static_any_handlers<T>::table = { &any_small::Destroy<T>, &any_small::Copy<T>, &any_small::Move<T>,
+	any_type_id_of<T>(), sizeof(T), alignof(T), is_trivially_relocatable_v<T>
+#if ANY_HAS_RTTI
+	, &any_type<T>
+#endif
+#if ANY_ENABLE_STATS
+	, &any_stats_of<T>::record
+#endif
+};
+
+template<size_t Capacity, size_t Align>
+class basic_static_any;
+
+template<class T>
+struct is_basic_static_any : std::false_type {};
+
+template<size_t Capacity, size_t Align>
+struct is_basic_static_any<basic_static_any<Capacity, Align>> : std::true_type {};
+
+template<size_t Capacity, size_t Align>
+class basic_static_any
+{
+	static_assert(Align >= alignof(void*) && (Align & (Align - 1)) == 0, "Align must be a power of two no smaller than alignof(void*)");
+
+	template<size_t, size_t>
+	friend class basic_static_any;
+
+public:
+	static constexpr size_t capacity = Capacity;
+	static constexpr size_t alignment = Align;
+
+	// Whether T can be stored, the constructors and emplace static_assert on it.
+	template<class T>
+	using fits = std::bool_constant<sizeof(T) <= Capacity && alignof(T) <= Align
+								 && std::is_nothrow_move_constructible_v<T> && std::is_nothrow_copy_constructible_v<T>>;
+
+	constexpr basic_static_any() noexcept
+		:_buffer{},
+		_handler{}
+	{
+	}
+
+	basic_static_any(const basic_static_any& other) noexcept
+		:_handler{}
+	{
+		copy_from(other);
+	}
+
+	basic_static_any(basic_static_any&& other) noexcept
+		:_handler{}
+	{
+		move_from(other);
+	}
+
+	// From anything smaller, which always fits.
+	template<size_t OtherCapacity, size_t OtherAlign, typename = std::enable_if_t<(OtherCapacity <= Capacity && OtherAlign <= Align
+																			   && (OtherCapacity != Capacity || OtherAlign != Align))>>
+	basic_static_any(const basic_static_any<OtherCapacity, OtherAlign>& other) noexcept
+		:_handler{}
+	{
+		copy_from(other);
+	}
+
+	template<size_t OtherCapacity, size_t OtherAlign, typename = std::enable_if_t<(OtherCapacity <= Capacity && OtherAlign <= Align
+																			   && (OtherCapacity != Capacity || OtherAlign != Align))>>
+	basic_static_any(basic_static_any<OtherCapacity, OtherAlign>&& other) noexcept
+		:_handler{}
+	{
+		move_from(other);
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_static_any<VT>::value
+										   && std::is_copy_constructible_v<VT>>>
+	basic_static_any(T&& value) noexcept
+		:_handler{}
+	{
+		emplace<VT>(std::forward<T>(value));
+	}
+
+	template<class T, class... Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+											       && std::is_constructible_v<VT, Args...>>>
+	explicit basic_static_any(std::in_place_type_t<T>, Args&&... args) noexcept
+		:_handler{}
+	{
+		emplace<VT>(std::forward<Args>(args)...);
+	}
+
+	template<class T, class U, class...Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+													 && std::is_constructible_v<VT, std::initializer_list<U>&, Args...>>>
+	explicit basic_static_any(std::in_place_type_t<T>, std::initializer_list<U> il, Args&&... args) noexcept
+		:_handler{}
+	{
+		emplace<VT>(il, std::forward<Args>(args)...);
+	}
+
+	~basic_static_any()
+	{
+		reset();
+	}
+
+	basic_static_any& operator=(const basic_static_any& rhs) noexcept
+	{
+		if (this != &rhs)
+		{
+			reset();
+			copy_from(rhs);
+		}
+		return *this;
+	}
+
+	basic_static_any& operator=(basic_static_any&& rhs) noexcept
+	{
+		if (this != &rhs)
+		{
+			reset();
+			move_from(rhs);
+		}
+		return *this;
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_static_any<VT>::value
+										   && std::is_copy_constructible_v<VT>>>
+	basic_static_any& operator=(T&& rhs) noexcept
+	{
+		emplace<VT>(std::forward<T>(rhs));
+		return *this;
+	}
+
+	// The arguments are evaluated before the old value is destroyed, but the construction itself must not throw.
+	template<class T, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+												 && std::is_constructible_v<VT, Args...>>>
+	std::decay_t<T>& emplace(Args&&... args) noexcept
+	{
+		check<VT>();
+		static_assert(std::is_nothrow_constructible_v<VT, Args...>, "static_any can only construct values without throwing");
+
+		reset();
+		ANY_STATS_COUNT_TYPE(VT, small_emplaces, 1);
+		Construct<VT>(_buffer, std::forward<Args>(args)...);
+		_handler = &static_any_handlers<VT>::table;
+		return *reinterpret_cast<VT*>(_buffer);
+	}
+
+	template<class T, class U, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<std::is_copy_constructible_v<VT>
+													  && std::is_constructible_v<VT, std::initializer_list<U>&, Args...>>>
+	std::decay_t<T>& emplace(std::initializer_list<U> il, Args&&... args) noexcept
+	{
+		check<VT>();
+		static_assert(std::is_nothrow_constructible_v<VT, std::initializer_list<U>&, Args...>, "static_any can only construct values without throwing");
+
+		reset();
+		ANY_STATS_COUNT_TYPE(VT, small_emplaces, 1);
+		Construct<VT>(_buffer, il, std::forward<Args>(args)...);
+		_handler = &static_any_handlers<VT>::table;
+		return *reinterpret_cast<VT*>(_buffer);
+	}
+
+	void reset() noexcept
+	{
+		if (_handler)
+		{
+			_handler->_destroy(_buffer, nullptr);
+			_handler = nullptr;
+		}
+	}
+
+	void swap(basic_static_any& rhs) noexcept
+	{
+		if (is_relocatable() && rhs.is_relocatable())
+		{
+			std::swap(_buffer, rhs._buffer);
+			std::swap(_handler, rhs._handler);
+			return;
+		}
+
+		basic_static_any tmp(std::move(rhs));
+		rhs = std::move(*this);
+		*this = std::move(tmp);
+	}
+
+	bool has_value() const noexcept
+	{
+		return _handler != nullptr;
+	}
+
+	any_type_id type_id() const noexcept
+	{
+		return has_value() ? _handler->_id : any_type_id_of<void>();
+	}
+
+#if ANY_HAS_RTTI
+	const std::type_info& type() const noexcept
+	{
+		return has_value() ? _handler->_type() : typeid(void);
+	}
+#endif
+
+	template<class T>
+	T* get_val() noexcept
+	{
+		return reinterpret_cast<T*>(_buffer);
+	}
+
+	template<class T>
+	const T* get_val() const noexcept
+	{
+		return reinterpret_cast<const T*>(_buffer);
+	}
+
+private:
+	template<class T>
+	static constexpr void check() noexcept
+	{
+		static_assert(sizeof(T) <= Capacity, "the type is too big for this static_any, raise its Capacity");
+		static_assert(alignof(T) <= Align, "the type is aligned stricter than this static_any, raise its Align");
+		static_assert(std::is_nothrow_move_constructible_v<T>, "static_any only holds types with a noexcept move constructor");
+		static_assert(std::is_nothrow_copy_constructible_v<T>, "static_any only holds types with a noexcept copy constructor");
+	}
+
+	bool is_relocatable() const noexcept
+	{
+		return !_handler || _handler->_trivially_relocatable;
+	}
+
+	template<size_t OtherCapacity, size_t OtherAlign>
+	void copy_from(const basic_static_any<OtherCapacity, OtherAlign>& other) noexcept
+	{
+		if (other._handler)
+		{
+			other._handler->_copy(_buffer, other._buffer, nullptr);
+			_handler = other._handler;
+		}
+	}
+
+	template<size_t OtherCapacity, size_t OtherAlign>
+	void move_from(basic_static_any<OtherCapacity, OtherAlign>& other) noexcept
+	{
+		if (!other._handler)
+		{
+			return;
+		}
+
+		if (other.is_relocatable())
+		{
+			std::memcpy(_buffer, other._buffer, std::min(Capacity, OtherCapacity));
+			ANY_STATS_COUNT(other._handler->_stats, moves, 1);
+		}
+		else
+		{
+			other._handler->_move(_buffer, other._buffer);
+		}
+
+		_handler = std::exchange(other._handler, nullptr);
+	}
+
+	alignas(Align) unsigned char _buffer[Capacity];
+	const static_any_handler* _handler;
+};
+
+using static_any = basic_static_any<small_space_size, small_space_align>;
+
+template<size_t Capacity, size_t Align>
+inline void swap(basic_static_any<Capacity, Align>& x, basic_static_any<Capacity, Align>& y) noexcept
+{
+	x.swap(y);
+}
+
+template<class T, size_t Capacity, size_t Align>
+T any_cast(const basic_static_any<Capacity, Align>& operand)
+{
+	return any_cast_impl::value<T>(operand);
+}
+
+template<class T, size_t Capacity, size_t Align>
+T any_cast(basic_static_any<Capacity, Align>& operand)
+{
+	return any_cast_impl::value<T>(operand);
+}
+
+template<class T, size_t Capacity, size_t Align>
+T any_cast(basic_static_any<Capacity, Align>&& operand)
+{
+	return any_cast_impl::value<T>(std::move(operand));
+}
+
+template<class T, size_t Capacity, size_t Align>
+const T* any_cast(const basic_static_any<Capacity, Align>* operand) noexcept
+{
+	return any_cast_impl::pointer<T>(operand);
+}
+
+template<class T, size_t Capacity, size_t Align>
+T* any_cast(basic_static_any<Capacity, Align>* operand) noexcept
+{
+	return any_cast_impl::pointer<T>(operand);
+}
@@ -0,0 +1,267 @@
+#pragma once
+/*
+	<unique_any> is the move-only sibling of <any>: it accepts types that can't be copied (std::unique_ptr, file handles,
+	move-only buffers) and has no copy operation at all.
+
+	It is built on the same any_storage as basic_any (see any.h): the same Capacity/Align/Alloc parameters, the same
+	any_small/any_big operations, relocation rules and any_cast overloads. Its handler tables just don't have a _copy
+	slot, so no copy constructor is ever instantiated for the stored types and every table is a pointer smaller.
+
+	Moving a value in constructs it directly in the buffer or the block, moving a unique_any around only moves the
+	pointer to the block (or relocates the small value), nothing is allocated unless the two allocators differ.
+*/
+
+#include "any.h"
+
+// any_handler without _copy
+struct unique_any_handler
+{
+	void (*_destroy)(void* storage, void* alloc) noexcept;
+	void (*_move)(void* destination, void* source) noexcept; // leaves <source> without a value
+	void (*_relocate)(void* destination, void* source); // object to object, used when a value changes representation or allocator
+	any_type_id _id;
+	size_t _size;
+	size_t _align;
+	any_representation _representation;
+	bool _trivially_relocatable; // the storage, so always true for big values
+	const unique_any_handler* _small; // nullptr if the type can never be stored inline
+	const unique_any_handler* _big;
+	size_t (*_hash)(const void* object);
+	bool (*_equal)(const void* object, const void* other);
+#if ANY_HAS_RTTI
+	const std::type_info& (*_type)() noexcept;
+#endif
+#if ANY_ENABLE_STATS
+	any_type_stats* _stats;
+#endif
+
+	void* object(void* storage) const noexcept
+	{
+		return _representation == any_representation::Big ? *static_cast<void**>(storage) : storage;
+	}
+
+	const void* object(const void* storage) const noexcept
+	{
+		return _representation == any_representation::Big ? *static_cast<void* const*>(storage) : storage;
+	}
+
+	bool fits(size_t capacity, size_t align, bool relocatable_only) const noexcept
+	{
+		return _small && _size <= capacity && _align <= align && (!relocatable_only || _small->_trivially_relocatable);
+	}
+};
+
+template<class T, class Alloc>
+struct unique_any_handlers
+{
+	static const unique_any_handler small;
+	static const unique_any_handler big;
+
+	static constexpr const unique_any_handler* small_or_null() noexcept
+	{
+		if constexpr (std::is_nothrow_move_constructible_v<T>)
+		{
+			return &small;
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+};
+
+template<class T, class Alloc>
+constexpr unique_any_handler unique_any_handlers<T, Alloc>::small = { &any_small::Destroy<T>, &any_small::Move<T>, &any_small::Move<T>,
+	any_type_id_of<T>(), sizeof(T), alignof(T), any_representation::Small, is_trivially_relocatable_v<T>, &unique_any_handlers<T, Alloc>::small, &unique_any_handlers<T, Alloc>::big,
+	any_compare::hash_or_null<T>(), any_compare::equal_or_null<T>()
+#if ANY_HAS_RTTI
+	, &any_type<T>
+#endif
+#if ANY_ENABLE_STATS
+	, &any_stats_of<T>::record
+#endif
+};
+
+template<class T, class Alloc>
+constexpr unique_any_handler unique_any_handlers<T, Alloc>::big = { &any_big::Destroy<T, Alloc>, &any_big::Move<T>, &any_big::Relocate<T>,
+	any_type_id_of<T>(), sizeof(T), alignof(T), any_representation::Big, true, unique_any_handlers<T, Alloc>::small_or_null(), &unique_any_handlers<T, Alloc>::big,
+	any_compare::hash_or_null<T>(), any_compare::equal_or_null<T>()
+#if ANY_HAS_RTTI
+	, &any_type<T>
+#endif
+#if ANY_ENABLE_STATS
+	, &any_stats_of<T>::record
+#endif
+};
+
+template<size_t Capacity, size_t Align, class Alloc = any_pool_allocator>
+class basic_unique_any;
+
+template<class T>
+struct is_basic_unique_any : std::false_type {};
+
+template<size_t Capacity, size_t Align, class Alloc>
+struct is_basic_unique_any<basic_unique_any<Capacity, Align, Alloc>> : std::true_type {};
+
+template<size_t Capacity, size_t Align, class Alloc>
+class basic_unique_any : public any_storage<basic_unique_any<Capacity, Align, Alloc>, unique_any_handler, Capacity, Align, Alloc, false>
+{
+	using base = any_storage<basic_unique_any, unique_any_handler, Capacity, Align, Alloc, false>;
+
+	friend base;
+
+	template<class T>
+	using handlers = unique_any_handlers<T, Alloc>;
+
+	using base::_storage;
+	using base::equal;
+	using base::move_from;
+	using base::relocate;
+
+public:
+	using base::hash;
+
+	constexpr basic_unique_any() noexcept
+		:base{}
+	{
+	}
+
+	basic_unique_any(std::allocator_arg_t, const Alloc& alloc) noexcept
+		:base{ alloc }
+	{
+	}
+
+	basic_unique_any(const basic_unique_any&) = delete;
+
+	basic_unique_any(basic_unique_any&& other) noexcept
+		:base{ other.get_allocator() }
+	{
+		relocate(_storage, other._storage);
+	}
+
+	// Only allocates when the allocators differ and the value is big.
+	basic_unique_any(std::allocator_arg_t, const Alloc& alloc, basic_unique_any&& other)
+		:base{ alloc }
+	{
+		move_from(other);
+	}
+
+	// Doesn't allocate unless the value is small in <other> but doesn't fit inside our buffer.
+	template<size_t OtherCapacity, size_t OtherAlign>
+	basic_unique_any(basic_unique_any<OtherCapacity, OtherAlign, Alloc>&& other)
+		:base{ other.get_allocator() }
+	{
+		move_from(other);
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_unique_any<VT>::value
+										   && std::is_constructible_v<VT, T>>>
+	basic_unique_any(T&& value)
+		:base{ Alloc{} }
+	{
+		emplace<VT>(std::forward<T>(value));
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_unique_any<VT>::value
+										   && std::is_constructible_v<VT, T>>>
+	basic_unique_any(std::allocator_arg_t, const Alloc& alloc, T&& value)
+		:base{ alloc }
+	{
+		emplace<VT>(std::forward<T>(value));
+	}
+
+	template<class T, class... Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<std::is_constructible_v<VT, Args...>>>
+	explicit basic_unique_any(std::in_place_type_t<T>, Args&&... args)
+		:base{ Alloc{} }
+	{
+		emplace<VT>(std::forward<Args>(args)...);
+	}
+
+	template<class T, class U, class...Args, typename VT = std::decay_t<T>, typename = std::enable_if_t<std::is_constructible_v<VT, std::initializer_list<U>&, Args...>>>
+	explicit basic_unique_any(std::in_place_type_t<T>, std::initializer_list<U> il, Args&&... args)
+		:base{ Alloc{} }
+	{
+		emplace<VT>(il, std::forward<Args>(args)...);
+	}
+
+	~basic_unique_any()
+	{
+		this->reset();
+	}
+
+	basic_unique_any& operator=(const basic_unique_any&) = delete;
+
+	basic_unique_any& operator=(basic_unique_any&& rhs) noexcept(Alloc::is_always_equal::value)
+	{
+		basic_unique_any(std::allocator_arg, this->get_allocator(), std::move(rhs)).swap(*this);
+		return *this;
+	}
+
+	template<class T, typename VT = std::decay_t<T>, typename = std::enable_if_t<!is_basic_unique_any<VT>::value
+										   && std::is_constructible_v<VT, T>>>
+	basic_unique_any& operator=(T&& rhs)
+	{
+		basic_unique_any(std::allocator_arg, this->get_allocator(), std::forward<T>(rhs)).swap(*this);
+		return *this;
+	}
+
+	template<class T, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<std::is_constructible_v<VT, Args...>>>
+	std::decay_t<T>& emplace(Args&&... args)
+	{
+		return this->template emplace_impl<VT>(std::forward<Args>(args)...);
+	}
+
+	template<class T, class U, typename VT = std::decay_t<T>, class... Args, typename = std::enable_if_t<std::is_constructible_v<VT, std::initializer_list<U>&, Args...>>>
+	std::decay_t<T>& emplace(std::initializer_list<U> il, Args&&... args)
+	{
+		return this->template emplace_impl<VT>(il, std::forward<Args>(args)...);
+	}
+
+	// Like basic_any's.
+	friend bool operator==(const basic_unique_any& lhs, const basic_unique_any& rhs)
+	{
+		return equal(lhs, rhs);
+	}
+
+	friend bool operator!=(const basic_unique_any& lhs, const basic_unique_any& rhs)
+	{
+		return !(lhs == rhs);
+	}
+};
+
+using unique_any = basic_unique_any<small_space_size, small_space_align>;
+
+namespace pmr
+{
+	template<size_t Capacity, size_t Align>
+	using basic_unique_any = ::basic_unique_any<Capacity, Align, any_resource_allocator>;
+
+	using unique_any = basic_unique_any<small_space_size, small_space_align>;
+}
+
+template<size_t Capacity, size_t Align, class Alloc>
+inline void swap(basic_unique_any<Capacity, Align, Alloc>& x, basic_unique_any<Capacity, Align, Alloc>& y) noexcept
+{
+	x.swap(y);
+}
+
+template<size_t Capacity, size_t Align, class Alloc>
+struct std::hash<basic_unique_any<Capacity, Align, Alloc>>
+{
+	size_t operator()(const basic_unique_any<Capacity, Align, Alloc>& value) const
+	{
+		return value.hash();
+	}
+};
+
+template<class T, class... Args>
+unique_any make_unique_any(Args&&... args)
+{
+	return unique_any{std::in_place_type<T>, std::forward<Args>(args)...};
+}
+
+template<class T, class U, class... Args>
+unique_any make_unique_any(std::initializer_list<U> il, Args&&... args)
+{
+	return unique_any{std::in_place_type<T>, il, std::forward<Args>(args)...};
+}